@@ -24,6 +24,12 @@
 #include "ScriptMgr.h"
 #include "ScriptedGossip.h"
 
+// Returns the state handling the hooks of objects on the object's map
+static ALE* StateOf(WorldObject const* object)
+{
+    return ALE::GetStateFor(object->FindMap());
+}
+
 class ALE_AllCreatureScript : public AllCreatureScript
 {
 public:
@@ -32,7 +38,7 @@ public:
     // Creature
     bool CanCreatureGossipHello(Player* player, Creature* creature) override
     {
-        if (sALE->OnGossipHello(player, creature))
+        if (StateOf(creature)->OnGossipHello(player, creature))
             return true;
 
         return false;
@@ -40,7 +46,7 @@ public:
 
     bool CanCreatureGossipSelect(Player* player, Creature* creature, uint32 sender, uint32 action) override
     {
-        if (sALE->OnGossipSelect(player, creature, sender, action))
+        if (StateOf(creature)->OnGossipSelect(player, creature, sender, action))
             return true;
 
         return false;
@@ -48,7 +54,7 @@ public:
 
     bool CanCreatureGossipSelectCode(Player* player, Creature* creature, uint32 sender, uint32 action, const char* code) override
     {
-        if (sALE->OnGossipSelectCode(player, creature, sender, action, code))
+        if (StateOf(creature)->OnGossipSelectCode(player, creature, sender, action, code))
             return true;
 
         return false;
@@ -56,8 +62,8 @@ public:
 
     void OnCreatureAddWorld(Creature* creature) override
     {
-        sALE->OnAddToWorld(creature);
-        sALE->OnAllCreatureAddToWorld(creature);
+        StateOf(creature)->OnAddToWorld(creature);
+        StateOf(creature)->OnAllCreatureAddToWorld(creature);
 
         if (creature->IsGuardian() && creature->ToTempSummon() && creature->ToTempSummon()->GetSummonerGUID().IsPlayer())
             sALE->OnPetAddedToWorld(creature->ToTempSummon()->GetSummonerUnit()->ToPlayer(), creature);
@@ -65,20 +71,20 @@ public:
 
     void OnCreatureRemoveWorld(Creature* creature) override
     {
-        sALE->OnRemoveFromWorld(creature);
-        sALE->OnAllCreatureRemoveFromWorld(creature);
+        StateOf(creature)->OnRemoveFromWorld(creature);
+        StateOf(creature)->OnAllCreatureRemoveFromWorld(creature);
     }
 
     bool CanCreatureQuestAccept(Player* player, Creature* creature, Quest const* quest) override
     {
         sALE->OnPlayerQuestAccept(player, quest);
-        sALE->OnQuestAccept(player, creature, quest);
+        StateOf(creature)->OnQuestAccept(player, creature, quest);
         return false;
     }
 
     bool CanCreatureQuestReward(Player* player, Creature* creature, Quest const* quest, uint32 opt) override
     {
-        if (sALE->OnQuestReward(player, creature, quest, opt))
+        if (StateOf(creature)->OnQuestReward(player, creature, quest, opt))
         {
             ClearGossipMenuFor(player);
             return true;
@@ -89,7 +95,7 @@ public:
 
     CreatureAI* GetCreatureAI(Creature* creature) const override
     {
-        if (CreatureAI* luaAI = sALE->GetAI(creature))
+        if (CreatureAI* luaAI = StateOf(creature)->GetAI(creature))
             return luaAI;
 
         return nullptr;
@@ -97,12 +103,12 @@ public:
 
     void OnCreatureSelectLevel(const CreatureTemplate* cinfo, Creature* creature) override
     {
-        sALE->OnAllCreatureSelectLevel(cinfo, creature);
+        StateOf(creature)->OnAllCreatureSelectLevel(cinfo, creature);
     }
 
     void OnBeforeCreatureSelectLevel(const CreatureTemplate* cinfo, Creature* creature, uint8& level) override
     {
-        sALE->OnAllCreatureBeforeSelectLevel(cinfo, creature, level);
+        StateOf(creature)->OnAllCreatureBeforeSelectLevel(cinfo, creature, level);
     }
 };
 
@@ -113,25 +119,25 @@ public:
 
     void OnGameObjectAddWorld(GameObject* go) override
     {
-        sALE->OnAddToWorld(go);
+        StateOf(go)->OnAddToWorld(go);
     }
 
     void OnGameObjectRemoveWorld(GameObject* go) override
     {
-        sALE->OnRemoveFromWorld(go);
+        StateOf(go)->OnRemoveFromWorld(go);
     }
 
     void OnGameObjectUpdate(GameObject* go, uint32 diff) override
     {
-        sALE->UpdateAI(go, diff);
+        StateOf(go)->UpdateAI(go, diff);
     }
 
     bool CanGameObjectGossipHello(Player* player, GameObject* go) override
     {
-        if (sALE->OnGossipHello(player, go))
+        if (StateOf(go)->OnGossipHello(player, go))
             return true;
 
-        if (sALE->OnGameObjectUse(player, go))
+        if (StateOf(go)->OnGameObjectUse(player, go))
             return true;
 
         return false;
@@ -139,34 +145,34 @@ public:
 
     void OnGameObjectDamaged(GameObject* go, Player* player) override
     {
-        sALE->OnDamaged(go, player);
+        StateOf(go)->OnDamaged(go, player);
     }
 
     void OnGameObjectDestroyed(GameObject* go, Player* player) override
     {
-        sALE->OnDestroyed(go, player);
+        StateOf(go)->OnDestroyed(go, player);
     }
 
     void OnGameObjectLootStateChanged(GameObject* go, uint32 state, Unit* /*unit*/) override
     {
-        sALE->OnLootStateChanged(go, state);
+        StateOf(go)->OnLootStateChanged(go, state);
     }
 
     void OnGameObjectStateChanged(GameObject* go, uint32 state) override
     {
-        sALE->OnGameObjectStateChanged(go, state);
+        StateOf(go)->OnGameObjectStateChanged(go, state);
     }
 
     bool CanGameObjectQuestAccept(Player* player, GameObject* go, Quest const* quest) override
     {
         sALE->OnPlayerQuestAccept(player, quest);
-        sALE->OnQuestAccept(player, go, quest);
+        StateOf(go)->OnQuestAccept(player, go, quest);
         return false;
     }
 
     bool CanGameObjectGossipSelect(Player* player, GameObject* go, uint32 sender, uint32 action) override
     {
-        if (sALE->OnGossipSelect(player, go, sender, action))
+        if (StateOf(go)->OnGossipSelect(player, go, sender, action))
             return true;
 
         return false;
@@ -174,7 +180,7 @@ public:
 
     bool CanGameObjectGossipSelectCode(Player* player, GameObject* go, uint32 sender, uint32 action, const char* code) override
     {
-        if (sALE->OnGossipSelectCode(player, go, sender, action, code))
+        if (StateOf(go)->OnGossipSelectCode(player, go, sender, action, code))
             return true;
 
         return false;
@@ -182,13 +188,13 @@ public:
 
     bool CanGameObjectQuestReward(Player* player, GameObject* go, Quest const* quest, uint32 opt) override
     {
-        if (sALE->OnQuestAccept(player, go, quest))
+        if (StateOf(go)->OnQuestAccept(player, go, quest))
         {
             sALE->OnPlayerQuestAccept(player, quest);
             return false;
         }
 
-        if (sALE->OnQuestReward(player, go, quest, opt))
+        if (StateOf(go)->OnQuestReward(player, go, quest, opt))
             return false;
 
         return false;
@@ -196,7 +202,7 @@ public:
 
     GameObjectAI* GetGameObjectAI(GameObject* go) const override
     {
-        sALE->OnSpawn(go);
+        StateOf(go)->OnSpawn(go);
         return nullptr;
     }
 };
@@ -268,37 +274,39 @@ public:
     void OnBeforeCreateInstanceScript(InstanceMap* instanceMap, InstanceScript** instanceData, bool /*load*/, std::string /*data*/, uint32 /*completedEncounterMask*/) override
     {
         if (instanceData)
-            *instanceData = sALE->GetInstanceData(instanceMap);
+            *instanceData = ALE::GetStateFor(instanceMap)->GetInstanceData(instanceMap);
     }
 
     void OnDestroyInstance(MapInstanced* /*mapInstanced*/, Map* map) override
     {
-        sALE->FreeInstanceId(map->GetInstanceId());
+        ALE::GetStateFor(map)->FreeInstanceId(map->GetInstanceId());
     }
 
     void OnCreateMap(Map* map) override
     {
-        sALE->OnCreate(map);
+        ALE::CreateMapState(map);
+        ALE::GetStateFor(map)->OnCreate(map);
     }
 
     void OnDestroyMap(Map* map) override
     {
-        sALE->OnDestroy(map);
+        ALE::GetStateFor(map)->OnDestroy(map);
+        ALE::DestroyMapState(map);
     }
 
     void OnPlayerEnterAll(Map* map, Player* player) override
     {
-        sALE->OnPlayerEnter(map, player);
+        ALE::GetStateFor(map)->OnPlayerEnter(map, player);
     }
 
     void OnPlayerLeaveAll(Map* map, Player* player) override
     {
-        sALE->OnPlayerLeave(map, player);
+        ALE::GetStateFor(map)->OnPlayerLeave(map, player);
     }
 
     void OnMapUpdate(Map* map, uint32 diff) override
     {
-        sALE->OnUpdate(map, diff);
+        ALE::GetStateFor(map)->OnUpdate(map, diff);
     }
 };
 
@@ -562,9 +570,9 @@ public:
     void GetDialogStatus(Player* player, Object* questgiver) override
     {
         if (questgiver->GetTypeId() == TYPEID_GAMEOBJECT)
-            sALE->GetDialogStatus(player, questgiver->ToGameObject());
+            StateOf(questgiver)->GetDialogStatus(player, questgiver->ToGameObject());
         else if (questgiver->GetTypeId() == TYPEID_UNIT)
-            sALE->GetDialogStatus(player, questgiver->ToCreature());
+            StateOf(questgiver)->GetDialogStatus(player, questgiver->ToCreature());
     }
 };
 
@@ -1007,12 +1015,12 @@ public:
 
     void OnDummyEffect(WorldObject* caster, uint32 spellID, SpellEffIndex effIndex, GameObject* gameObjTarget) override
     {
-        sALE->OnDummyEffect(caster, spellID, effIndex, gameObjTarget);
+        StateOf(gameObjTarget)->OnDummyEffect(caster, spellID, effIndex, gameObjTarget);
     }
 
     void OnDummyEffect(WorldObject* caster, uint32 spellID, SpellEffIndex effIndex, Creature* creatureTarget) override
     {
-        sALE->OnDummyEffect(caster, spellID, effIndex, creatureTarget);
+        StateOf(creatureTarget)->OnDummyEffect(caster, spellID, effIndex, creatureTarget);
     }
 
     void OnDummyEffect(WorldObject* caster, uint32 spellID, SpellEffIndex effIndex, Item* itemTarget) override
@@ -1073,7 +1081,6 @@ public:
     ALE_WorldObjectScript() : WorldObjectScript("ALE_WorldObjectScript", {
         WORLDOBJECTHOOK_ON_WORLD_OBJECT_DESTROY,
         WORLDOBJECTHOOK_ON_WORLD_OBJECT_CREATE,
-        WORLDOBJECTHOOK_ON_WORLD_OBJECT_SET_MAP,
         WORLDOBJECTHOOK_ON_WORLD_OBJECT_UPDATE
     }) { }
 
@@ -1088,15 +1095,11 @@ public:
         object->ALEEvents = nullptr;
     }
 
-    void OnWorldObjectSetMap(WorldObject* object, Map* /*map*/) override
-    {
-        if (!object->ALEEvents)
-            object->ALEEvents = new ALEEventProcessor(&ALE::GALE, object);
-    }
-
     void OnWorldObjectUpdate(WorldObject* object, uint32 diff) override
     {
-        object->ALEEvents->Update(diff);
+        // The event processor is created by the first RegisterEvent on the object
+        if (object->ALEEvents)
+            object->ALEEvents->Update(diff);
     }
 };
 
@@ -1223,8 +1226,8 @@ public:
 
         if (unit->IsCreature())
         {
-            sALE->OnCreatureAuraApply(unit->ToCreature(), aura);
-            sALE->OnAllCreatureAuraApply(unit->ToCreature(), aura);
+            StateOf(unit)->OnCreatureAuraApply(unit->ToCreature(), aura);
+            StateOf(unit)->OnAllCreatureAuraApply(unit->ToCreature(), aura);
         }
     }
 
@@ -1237,8 +1240,8 @@ public:
 
         if (unit->IsCreature())
         {
-            sALE->OnCreatureAuraRemove(unit->ToCreature(), aurApp->GetBase(), mode);
-            sALE->OnAllCreatureAuraRemove(unit->ToCreature(), aurApp->GetBase(), mode);
+            StateOf(unit)->OnCreatureAuraRemove(unit->ToCreature(), aurApp->GetBase(), mode);
+            StateOf(unit)->OnAllCreatureAuraRemove(unit->ToCreature(), aurApp->GetBase(), mode);
         }
     }
 
@@ -1251,8 +1254,8 @@ public:
 
         if (healer->IsCreature())
         {
-            sALE->OnCreatureHeal(healer->ToCreature(), receiver, gain);
-            sALE->OnAllCreatureHeal(healer->ToCreature(), receiver, gain);
+            StateOf(healer)->OnCreatureHeal(healer->ToCreature(), receiver, gain);
+            StateOf(healer)->OnAllCreatureHeal(healer->ToCreature(), receiver, gain);
         }
     }
 
@@ -1265,8 +1268,8 @@ public:
 
         if (attacker->IsCreature())
         {
-            sALE->OnCreatureDamage(attacker->ToCreature(), receiver, damage);
-            sALE->OnAllCreatureDamage(attacker->ToCreature(), receiver, damage);
+            StateOf(attacker)->OnCreatureDamage(attacker->ToCreature(), receiver, damage);
+            StateOf(attacker)->OnAllCreatureDamage(attacker->ToCreature(), receiver, damage);
         }
     }
 
@@ -1279,8 +1282,8 @@ public:
 
         if (attacker->IsCreature())
         {
-            sALE->OnCreatureModifyPeriodicDamageAurasTick(attacker->ToCreature(), target, damage, spellInfo);
-            sALE->OnAllCreatureModifyPeriodicDamageAurasTick(attacker->ToCreature(), target, damage, spellInfo);
+            StateOf(attacker)->OnCreatureModifyPeriodicDamageAurasTick(attacker->ToCreature(), target, damage, spellInfo);
+            StateOf(attacker)->OnAllCreatureModifyPeriodicDamageAurasTick(attacker->ToCreature(), target, damage, spellInfo);
         }
     }
 
@@ -1293,8 +1296,8 @@ public:
 
         if (attacker->IsCreature())
         {
-            sALE->OnCreatureModifyMeleeDamage(attacker->ToCreature(), target, damage);
-            sALE->OnAllCreatureModifyMeleeDamage(attacker->ToCreature(), target, damage);
+            StateOf(attacker)->OnCreatureModifyMeleeDamage(attacker->ToCreature(), target, damage);
+            StateOf(attacker)->OnAllCreatureModifyMeleeDamage(attacker->ToCreature(), target, damage);
         }
     }
 
@@ -1307,8 +1310,8 @@ public:
 
         if (attacker->IsCreature())
         {
-            sALE->OnCreatureModifySpellDamageTaken(attacker->ToCreature(), target, damage, spellInfo);
-            sALE->OnAllCreatureModifySpellDamageTaken(attacker->ToCreature(), target, damage, spellInfo);
+            StateOf(attacker)->OnCreatureModifySpellDamageTaken(attacker->ToCreature(), target, damage, spellInfo);
+            StateOf(attacker)->OnAllCreatureModifySpellDamageTaken(attacker->ToCreature(), target, damage, spellInfo);
         }
     }
 
@@ -1321,8 +1324,8 @@ public:
 
         if (healer->IsCreature())
         {
-            sALE->OnCreatureModifyHealReceived(healer->ToCreature(), target, heal, spellInfo);
-            sALE->OnAllCreatureModifyHealReceived(healer->ToCreature(), target, heal, spellInfo);
+            StateOf(healer)->OnCreatureModifyHealReceived(healer->ToCreature(), target, heal, spellInfo);
+            StateOf(healer)->OnAllCreatureModifyHealReceived(healer->ToCreature(), target, heal, spellInfo);
         }
     }
 
@@ -1334,7 +1337,7 @@ public:
             return sALE->OnPlayerDealDamage(AttackerUnit->ToPlayer(), pVictim, damage, damagetype);
 
         if (AttackerUnit->IsCreature())
-            return sALE->OnCreatureDealDamage(AttackerUnit->ToCreature(), pVictim, damage, damagetype);
+            return StateOf(AttackerUnit)->OnCreatureDealDamage(AttackerUnit->ToCreature(), pVictim, damage, damagetype);
 
         return damage;
     }
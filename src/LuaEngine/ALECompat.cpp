@@ -86,3 +86,16 @@ void luaL_setmetatable(lua_State* L, const char* tname) {
 }
 #endif
 #endif
+
+#if LUA_VERSION_NUM < 504
+int ALE_resume(lua_State* L, lua_State* from, int nargs, int* nresults) {
+#if LUA_VERSION_NUM == 501
+    (void)from;
+    int result = (lua_resume)(L, nargs);
+#else
+    int result = (lua_resume)(L, from, nargs);
+#endif
+    *nresults = lua_gettop(L);
+    return result;
+}
+#endif
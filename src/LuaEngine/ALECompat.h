@@ -44,4 +44,17 @@ extern "C"
     #define lua_pushunsigned(L, u) \
         lua_pushinteger(L, u)
 #endif
+
+/* lua_resume takes the resuming state and returns the number of results since Lua 5.4 */
+#if LUA_VERSION_NUM < 504
+    int ALE_resume(lua_State* L, lua_State* from, int nargs, int* nresults);
+    #define lua_resume(L, from, nargs, nresults) \
+        ALE_resume(L, from, nargs, nresults)
+#endif
+
+/* 64-bit values are boxed in userdata unless the ALE_NATIVE_INT64 build option asks for native integers
+ * and lua_Integer can hold them */
+#if defined(ALE_USE_NATIVE_INT64) && LUA_VERSION_NUM >= 503 && LUA_MAXINTEGER >= 9223372036854775807LL
+    #define ALE_NATIVE_INT64
+#endif
 #endif
@@ -21,10 +21,13 @@ void ALEConfig::BuildConfigCache()
     SetConfigValue<bool>(ALEConfigValues::TRACEBACK_ENABLED,          "ALE.TraceBack",          "false");
     SetConfigValue<bool>(ALEConfigValues::AUTORELOAD_ENABLED,         "ALE.AutoReload",         "false");
     SetConfigValue<bool>(ALEConfigValues::BYTECODE_CACHE_ENABLED,     "ALE.BytecodeCache",      "false");
+    SetConfigValue<bool>(ALEConfigValues::MULTISTATE_ENABLED,         "ALE.MultiState",         "false");
 
     SetConfigValue<std::string>(ALEConfigValues::SCRIPT_PATH,         "ALE.ScriptPath",         "lua_scripts");
     SetConfigValue<std::string>(ALEConfigValues::REQUIRE_PATH,        "ALE.RequirePaths",       "");
     SetConfigValue<std::string>(ALEConfigValues::REQUIRE_CPATH,       "ALE.RequireCPaths",      "");
+    SetConfigValue<std::string>(ALEConfigValues::BYTECODE_CACHE_PATH, "ALE.BytecodeCachePath",  "");
+    SetConfigValue<std::string>(ALEConfigValues::SCRIPT_ARCHIVE,      "ALE.ScriptArchive",      "");
 
     SetConfigValue<uint32>(ALEConfigValues::AUTORELOAD_INTERVAL,      "ALE.AutoReloadInterval", 1);
 }
@@ -10,11 +10,14 @@ enum class ALEConfigValues : uint32
     TRACEBACK_ENABLED,
     AUTORELOAD_ENABLED,
     BYTECODE_CACHE_ENABLED,
+    MULTISTATE_ENABLED,
 
     // String
     SCRIPT_PATH,
     REQUIRE_PATH,
     REQUIRE_CPATH,
+    BYTECODE_CACHE_PATH,
+    SCRIPT_ARCHIVE,
 
     // Number
     AUTORELOAD_INTERVAL,
@@ -33,10 +36,13 @@ class ALEConfig final : public ConfigValueCache<ALEConfigValues>
         bool IsTraceBackEnabled() const { return GetConfigValue<bool>(ALEConfigValues::TRACEBACK_ENABLED); }
         bool IsAutoReloadEnabled() const { return GetConfigValue<bool>(ALEConfigValues::AUTORELOAD_ENABLED); }
         bool IsByteCodeCacheEnabled() const { return GetConfigValue<bool>(ALEConfigValues::BYTECODE_CACHE_ENABLED); }
+        bool IsMultiStateEnabled() const { return GetConfigValue<bool>(ALEConfigValues::MULTISTATE_ENABLED); }
 
         std::string_view GetScriptPath() const { return GetConfigValue(ALEConfigValues::SCRIPT_PATH); }
         std::string_view GetRequirePath() const { return GetConfigValue(ALEConfigValues::REQUIRE_PATH); }
         std::string_view GetRequireCPath() const { return GetConfigValue(ALEConfigValues::REQUIRE_CPATH); }
+        std::string_view GetByteCodeCachePath() const { return GetConfigValue(ALEConfigValues::BYTECODE_CACHE_PATH); }
+        std::string_view GetScriptArchive() const { return GetConfigValue(ALEConfigValues::SCRIPT_ARCHIVE); }
 
         uint32 GetAutoReloadInterval() const { return GetConfigValue<uint32>(ALEConfigValues::AUTORELOAD_INTERVAL); }
 
@@ -0,0 +1,209 @@
+/*
+* Copyright (C) 2010 - 2025 Eluna Lua Engine <https://elunaluaengine.github.io/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+#include "ALECoroutineScheduler.h"
+#include "ALECompat.h"
+#include "LuaEngine.h"
+
+extern "C"
+{
+#include "lua.h"
+#include "lauxlib.h"
+};
+
+ALECoroutineScheduler::ALECoroutineScheduler() : time(0), sleepOrder(0), lastWaitId(0)
+{
+}
+
+void ALECoroutineScheduler::Start(ALE* E, lua_State* L, int nargs)
+{
+    // Stack: function, [arguments]
+    lua_State* thread = lua_newthread(L);
+    lua_insert(L, -(nargs + 2));
+    // Stack: thread, function, [arguments]
+    lua_xmove(L, thread, nargs + 1);
+    // Stack: thread
+
+    Coroutine coroutine;
+    coroutine.ref = luaL_ref(L, LUA_REGISTRYINDEX);
+    coroutine.waitId = 0;
+    coroutines[thread] = coroutine;
+
+    Resume(E, L, thread, nargs);
+}
+
+bool ALECoroutineScheduler::IsCoroutine(lua_State* thread) const
+{
+    return coroutines.find(thread) != coroutines.end();
+}
+
+uint32 ALECoroutineScheduler::StartWait(lua_State* thread)
+{
+    // 0 is reserved for running coroutines
+    if (!++lastWaitId)
+        ++lastWaitId;
+
+    coroutines[thread].waitId = lastWaitId;
+    return lastWaitId;
+}
+
+void ALECoroutineScheduler::Sleep(lua_State* thread, uint32 delay)
+{
+    SleepEntry entry;
+    entry.wakeTime = time + delay;
+    entry.order = sleepOrder++;
+    entry.thread = thread;
+    entry.waitId = StartWait(thread);
+    sleeping.push(entry);
+}
+
+void ALECoroutineScheduler::PushResumer(lua_State* thread)
+{
+    uint32 waitId = StartWait(thread);
+
+    lua_pushthread(thread);
+    ALE::Push(thread, waitId);
+    lua_pushcclosure(thread, &ResumeFromCall, 2);
+}
+
+/*
+ * Waiting globals don't call lua_yield themselves. On Lua 5.1 and LuaJIT a C function can only
+ *   yield as its tail call, which the method thunk doesn't allow, and on 5.2+ lua_yield unwinds
+ *   the C++ frame without running destructors. They return this marker instead and the Lua
+ *   wrapper installed by WrapWaitingFunctions yields for them.
+ */
+static const char waitRequestMarker = 0;
+
+int ALECoroutineScheduler::PushWaitRequest(lua_State* L)
+{
+    lua_pushlightuserdata(L, const_cast<char*>(&waitRequestMarker));
+    return 1;
+}
+
+void ALECoroutineScheduler::WrapWaitingFunctions(lua_State* L)
+{
+    static const char* const wrapper =
+        "local marker, yield = ...\n"
+        "local function wrap(f)\n"
+        "    return function(...)\n"
+        "        if f(...) == marker then\n"
+        "            return yield()\n"
+        "        end\n"
+        "    end\n"
+        "end\n"
+        "for _, name in ipairs({ 'Sleep', 'WaitForEvent', 'WorldDBQueryAsync', 'CharDBQueryAsync', 'AuthDBQueryAsync', 'HttpRequest' }) do\n"
+        "    _G[name] = wrap(_G[name])\n"
+        "end\n";
+
+    if (luaL_loadstring(L, wrapper))
+    {
+        ALE::Report(L);
+        return;
+    }
+
+    PushWaitRequest(L);
+    lua_getglobal(L, "coroutine");
+    lua_getfield(L, -1, "yield");
+    lua_remove(L, -2);
+    // Stack: wrapper, marker, yield
+    if (lua_pcall(L, 2, 0, 0))
+        ALE::Report(L);
+}
+
+void ALECoroutineScheduler::Update(ALE* E, uint32 diff)
+{
+    time += diff;
+
+    if (sleeping.empty() || sleeping.top().wakeTime > time)
+        return;
+
+    ALE::Guard guard(E->GetStateLock());
+
+    // Coroutines that go back to sleep during this update wake up on the next one at the earliest
+    uint64 updateOrder = sleepOrder;
+    while (!sleeping.empty())
+    {
+        SleepEntry entry = sleeping.top();
+        if (entry.wakeTime > time || entry.order >= updateOrder)
+            break;
+        sleeping.pop();
+
+        // Woken up by something else in the meantime or already finished
+        auto itr = coroutines.find(entry.thread);
+        if (itr == coroutines.end() || itr->second.waitId != entry.waitId)
+            continue;
+
+        Resume(E, E->L, entry.thread, 0);
+    }
+
+    if (!E->event_level)
+        E->InvalidateObjects();
+}
+
+void ALECoroutineScheduler::Clear()
+{
+    // The threads are freed with the Lua state
+    coroutines.clear();
+    sleeping = decltype(sleeping)();
+}
+
+void ALECoroutineScheduler::Resume(ALE* E, lua_State* from, lua_State* thread, int nargs)
+{
+    coroutines[thread].waitId = 0;
+
+    int nresults = 0;
+    ++E->event_level;
+    int result = lua_resume(thread, from, nargs, &nresults);
+    --E->event_level;
+
+    if (result == LUA_YIELD)
+    {
+        lua_pop(thread, nresults);
+
+        // A plain coroutine.yield() waits for the next update
+        auto itr = coroutines.find(thread);
+        if (itr != coroutines.end() && !itr->second.waitId)
+            Sleep(thread, 0);
+        return;
+    }
+
+    if (result != LUA_OK)
+        ALE::Report(thread);
+
+    // Resumed coroutines may have started others, look the coroutine up again
+    auto itr = coroutines.find(thread);
+    if (itr != coroutines.end())
+    {
+        luaL_unref(E->L, LUA_REGISTRYINDEX, itr->second.ref);
+        coroutines.erase(itr);
+    }
+}
+
+int ALECoroutineScheduler::ResumeFromCall(lua_State* L)
+{
+    lua_State* thread = lua_tothread(L, lua_upvalueindex(1));
+    uint32 waitId = static_cast<uint32>(lua_tointeger(L, lua_upvalueindex(2)));
+
+    ALE* E = ALE::GetALE(L);
+    ALECoroutineScheduler& scheduler = E->coroutineScheduler;
+
+    // The coroutine was already resumed by an earlier call, woke up otherwise or is gone
+    auto itr = scheduler.coroutines.find(thread);
+    if (itr == scheduler.coroutines.end() || itr->second.waitId != waitId)
+        return 0;
+
+    // Called before the coroutine got to yield, for example by a callback that runs immediately
+    if (lua_status(thread) != LUA_YIELD)
+        return luaL_error(L, "coroutine resumed before it started waiting");
+
+    int nargs = lua_gettop(L);
+    if (!lua_checkstack(thread, nargs))
+        return luaL_error(L, "too many arguments to resume the coroutine with");
+
+    lua_xmove(L, thread, nargs);
+    scheduler.Resume(E, L, thread, nargs);
+    return 0;
+}
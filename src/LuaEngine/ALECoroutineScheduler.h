@@ -0,0 +1,85 @@
+/*
+* Copyright (C) 2010 - 2025 Eluna Lua Engine <https://elunaluaengine.github.io/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+#ifndef _ALE_COROUTINE_SCHEDULER_H
+#define _ALE_COROUTINE_SCHEDULER_H
+
+#include "Common.h"
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+extern "C"
+{
+#include "lua.h"
+};
+
+class ALE;
+
+/*
+ * Runs Lua functions as coroutines that can wait for a delay, an event or an asynchronous result.
+ *
+ * A coroutine is anchored in the registry once for its whole life. Waiting does not create
+ *   timed events or function references, sleeping coroutines are kept in a heap ordered
+ *   by their wake up time and resumed from the world (or map) update of their state.
+ */
+class ALECoroutineScheduler
+{
+public:
+    ALECoroutineScheduler();
+
+    // Runs the function below `nargs` arguments on top of the stack of L as a new coroutine
+    void Start(ALE* E, lua_State* L, int nargs);
+    // Returns true if `thread` is a coroutine started with Start
+    bool IsCoroutine(lua_State* thread) const;
+    // Makes the coroutine wait for `delay` milliseconds, the caller must yield after this
+    void Sleep(lua_State* thread, uint32 delay);
+    // Pushes a function resuming the coroutine with the arguments it is called with, the caller must yield after this
+    void PushResumer(lua_State* thread);
+    // Pushes the value a waiting global returns to make its Lua wrapper yield, see WrapWaitingFunctions
+    static int PushWaitRequest(lua_State* L);
+    // Wraps the globals that can make a coroutine wait, so they yield from Lua instead of from C
+    static void WrapWaitingFunctions(lua_State* L);
+    // Resumes the coroutines that are done sleeping
+    void Update(ALE* E, uint32 diff);
+    // Forgets all coroutines, called before the Lua state is closed
+    void Clear();
+
+private:
+    struct Coroutine
+    {
+        int ref;        // Registry reference keeping the thread alive
+        uint32 waitId;  // ID of the current wait, 0 while running
+    };
+
+    struct SleepEntry
+    {
+        uint64 wakeTime;
+        uint64 order;
+        lua_State* thread;
+        uint32 waitId;
+    };
+
+    struct WakesLater
+    {
+        bool operator()(SleepEntry const& lhs, SleepEntry const& rhs) const
+        {
+            return lhs.wakeTime != rhs.wakeTime ? lhs.wakeTime > rhs.wakeTime : lhs.order > rhs.order;
+        }
+    };
+
+    uint32 StartWait(lua_State* thread);
+    void Resume(ALE* E, lua_State* from, lua_State* thread, int nargs);
+    static int ResumeFromCall(lua_State* L);
+
+    std::unordered_map<lua_State*, Coroutine> coroutines;
+    std::priority_queue<SleepEntry, std::vector<SleepEntry>, WakesLater> sleeping;
+    uint64 time;
+    uint64 sleepOrder;
+    uint32 lastWaitId;
+};
+
+#endif
@@ -17,12 +17,38 @@ struct ALECreatureAI : ScriptedAI
     bool justSpawned;
     // used to delay movementinform hook (WP hook)
     std::vector< std::pair<uint32, uint32> > movepoints;
+    // the state that created the AI, the state of the creature's map when multistate is enabled
+    ALE* E;
+    // timers of the AI update handlers registered with an interval
+    ALEUpdateTimers updateTimers;
+    // cached mask of the creature events the creature has bindings for, valid while the generations match the binding maps
+    uint64 eventMask;
+    uint64 entryGeneration;
+    uint64 uniqueGeneration;
 
-    ALECreatureAI(Creature* creature) : ScriptedAI(creature), justSpawned(true)
+    static_assert(Hooks::CREATURE_EVENT_COUNT <= 64, "creature events must fit in eventMask");
+
+    ALECreatureAI(Creature* creature, ALE* _E) : ScriptedAI(creature), justSpawned(true), E(_E), eventMask(0), entryGeneration(0), uniqueGeneration(0)
     {
     }
     ~ALECreatureAI() { }
 
+    // Checks the cached event mask so hooks nobody listens to are skipped without locking or hashing
+    bool HasBindings(Hooks::CreatureEvents event_id)
+    {
+        uint64 entryGen = E->CreatureEventBindings->GetGeneration();
+        uint64 uniqueGen = E->CreatureUniqueBindings->GetGeneration();
+        if (entryGen != entryGeneration || uniqueGen != uniqueGeneration)
+        {
+            // The generations are read first, changes after this are picked up by the next check
+            entryGeneration = entryGen;
+            uniqueGeneration = uniqueGen;
+            eventMask = E->CreatureEventBindings->GetEventMaskForObject(EntryKey<Hooks::CreatureEvents>(event_id, me->GetEntry()), Hooks::CREATURE_EVENT_COUNT) |
+                E->CreatureUniqueBindings->GetEventMaskForObject(UniqueObjectKey<Hooks::CreatureEvents>(event_id, me->GET_GUID(), me->GetInstanceId()), Hooks::CREATURE_EVENT_COUNT);
+        }
+        return (eventMask & (uint64(1) << event_id)) != 0;
+    }
+
     //Called at World update tick
     void UpdateAI(uint32 diff) override
     {
@@ -37,13 +63,13 @@ struct ALECreatureAI : ScriptedAI
         {
             for (auto& point : movepoints)
             {
-                if (!sALE->MovementInform(me, point.first, point.second))
+                if (!HasBindings(Hooks::CREATURE_EVENT_ON_REACH_WP) || !E->MovementInform(me, point.first, point.second))
                     ScriptedAI::MovementInform(point.first, point.second);
             }
             movepoints.clear();
         }
 
-        if (!sALE->UpdateAI(me, diff))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_AIUPDATE) || !E->UpdateAI(me, diff, updateTimers))
         {
             if (!me->HasFlag(UNIT_FIELD_FLAGS, UNIT_FLAG_IMMUNE_TO_NPC))
                 ScriptedAI::UpdateAI(diff);
@@ -54,14 +80,14 @@ struct ALECreatureAI : ScriptedAI
     // Called at creature aggro either by MoveInLOS or Attack Start
     void JustEngagedWith(Unit* target) override
     {
-        if (!sALE->EnterCombat(me, target))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_ENTER_COMBAT) || !E->EnterCombat(me, target))
             ScriptedAI::JustEngagedWith(target);
     }
 
     // Called at any Damage from any attacker (before damage apply)
     void DamageTaken(Unit* attacker, uint32& damage, DamageEffectType damagetype, SpellSchoolMask damageSchoolMask) override
     {
-        if (!sALE->DamageTaken(me, attacker, damage))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_DAMAGE_TAKEN) || !E->DamageTaken(me, attacker, damage))
         {
             ScriptedAI::DamageTaken(attacker, damage, damagetype, damageSchoolMask);
         }
@@ -70,28 +96,28 @@ struct ALECreatureAI : ScriptedAI
     //Called at creature death
     void JustDied(Unit* killer) override
     {
-        if (!sALE->JustDied(me, killer))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_DIED) || !E->JustDied(me, killer))
             ScriptedAI::JustDied(killer);
     }
 
     //Called at creature killing another unit
     void KilledUnit(Unit* victim) override
     {
-        if (!sALE->KilledUnit(me, victim))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_TARGET_DIED) || !E->KilledUnit(me, victim))
             ScriptedAI::KilledUnit(victim);
     }
 
     // Called when the creature summon successfully other creature
     void JustSummoned(Creature* summon) override
     {
-        if (!sALE->JustSummoned(me, summon))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_JUST_SUMMONED_CREATURE) || !E->JustSummoned(me, summon))
             ScriptedAI::JustSummoned(summon);
     }
 
     // Called when a summoned creature is despawned
     void SummonedCreatureDespawn(Creature* summon) override
     {
-        if (!sALE->SummonedCreatureDespawn(me, summon))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_SUMMONED_CREATURE_DESPAWN) || !E->SummonedCreatureDespawn(me, summon))
             ScriptedAI::SummonedCreatureDespawn(summon);
     }
 
@@ -106,89 +132,89 @@ struct ALECreatureAI : ScriptedAI
     // Called before EnterCombat even before the creature is in combat.
     void AttackStart(Unit* target) override
     {
-        if (!sALE->AttackStart(me, target))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_PRE_COMBAT) || !E->AttackStart(me, target))
             ScriptedAI::AttackStart(target);
     }
 
     // Called for reaction at stopping attack at no attackers or targets
     void EnterEvadeMode(EvadeReason /*why*/) override
     {
-        if (!sALE->EnterEvadeMode(me))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_LEAVE_COMBAT) || !E->EnterEvadeMode(me))
             ScriptedAI::EnterEvadeMode();
     }
 
     // Called when creature is spawned or respawned (for reseting variables)
     void JustRespawned() override
     {
-        if (!sALE->JustRespawned(me))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_SPAWN) || !E->JustRespawned(me))
             ScriptedAI::JustRespawned();
     }
 
     // Called at reaching home after evade
     void JustReachedHome() override
     {
-        if (!sALE->JustReachedHome(me))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_REACH_HOME) || !E->JustReachedHome(me))
             ScriptedAI::JustReachedHome();
     }
 
     // Called at text emote receive from player
     void ReceiveEmote(Player* player, uint32 emoteId) override
     {
-        if (!sALE->ReceiveEmote(me, player, emoteId))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_RECEIVE_EMOTE) || !E->ReceiveEmote(me, player, emoteId))
             ScriptedAI::ReceiveEmote(player, emoteId);
     }
 
     // called when the corpse of this creature gets removed
     void CorpseRemoved(uint32& respawnDelay) override
     {
-        if (!sALE->CorpseRemoved(me, respawnDelay))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_CORPSE_REMOVED) || !E->CorpseRemoved(me, respawnDelay))
             ScriptedAI::CorpseRemoved(respawnDelay);
     }
 
     void MoveInLineOfSight(Unit* who) override
     {
-        if (!sALE->MoveInLineOfSight(me, who))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_MOVE_IN_LOS) || !E->MoveInLineOfSight(me, who))
             ScriptedAI::MoveInLineOfSight(who);
     }
 
     // Called when hit by a spell
     void SpellHit(Unit* caster, SpellInfo const* spell) override
     {
-        if (!sALE->SpellHit(me, caster, spell))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_HIT_BY_SPELL) || !E->SpellHit(me, caster, spell))
             ScriptedAI::SpellHit(caster, spell);
     }
 
     // Called when spell hits a target
     void SpellHitTarget(Unit* target, SpellInfo const* spell) override
     {
-        if (!sALE->SpellHitTarget(me, target, spell))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_SPELL_HIT_TARGET) || !E->SpellHitTarget(me, target, spell))
             ScriptedAI::SpellHitTarget(target, spell);
     }
 
     // Called when the creature is summoned successfully by other creature
     void IsSummonedBy(WorldObject* summoner) override
     {
-        if (!summoner->ToUnit() || !sALE->OnSummoned(me, summoner->ToUnit()))
+        if (!summoner->ToUnit() || !HasBindings(Hooks::CREATURE_EVENT_ON_SUMMONED) || !E->OnSummoned(me, summoner->ToUnit()))
             ScriptedAI::IsSummonedBy(summoner);
     }
 
     void SummonedCreatureDies(Creature* summon, Unit* killer) override
     {
-        if (!sALE->SummonedCreatureDies(me, summon, killer))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_SUMMONED_CREATURE_DIED) || !E->SummonedCreatureDies(me, summon, killer))
             ScriptedAI::SummonedCreatureDies(summon, killer);
     }
 
     // Called when owner takes damage
     void OwnerAttackedBy(Unit* attacker) override
     {
-        if (!sALE->OwnerAttackedBy(me, attacker))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_OWNER_ATTACKED_AT) || !E->OwnerAttackedBy(me, attacker))
             ScriptedAI::OwnerAttackedBy(attacker);
     }
 
     // Called when owner attacks something
     void OwnerAttacked(Unit* target) override
     {
-        if (!sALE->OwnerAttacked(me, target))
+        if (!HasBindings(Hooks::CREATURE_EVENT_ON_OWNER_ATTACKED) || !E->OwnerAttacked(me, target))
             ScriptedAI::OwnerAttacked(target);
     }
 };
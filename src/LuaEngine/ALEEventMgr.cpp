@@ -8,13 +8,70 @@
 #include "LuaEngine.h"
 #include "Object.h"
 
+#include <algorithm>
+#include <vector>
+
 extern "C"
 {
 #include "lua.h"
 #include "lauxlib.h"
 };
 
-ALEEventProcessor::ALEEventProcessor(ALE** _E, WorldObject* _obj) : m_time(0), obj(_obj), E(_E)
+namespace
+{
+    // Freed events of this thread, reused by LuaEvent::operator new
+    struct LuaEventPool
+    {
+        static constexpr size_t MAX_FREE = 4096;
+
+        LuaEventPool() : head(NULL), count(0) { }
+
+        ~LuaEventPool()
+        {
+            while (head)
+            {
+                void* node = head;
+                head = *static_cast<void**>(node);
+                ::operator delete(node);
+            }
+        }
+
+        void* head;
+        size_t count;
+    };
+
+    thread_local LuaEventPool eventPool;
+}
+
+void* LuaEvent::operator new(size_t size)
+{
+    if (size == sizeof(LuaEvent) && eventPool.head)
+    {
+        void* node = eventPool.head;
+        eventPool.head = *static_cast<void**>(node);
+        --eventPool.count;
+        return node;
+    }
+    return ::operator new(size);
+}
+
+void LuaEvent::operator delete(void* ptr)
+{
+    if (!ptr)
+        return;
+
+    if (eventPool.count >= LuaEventPool::MAX_FREE)
+    {
+        ::operator delete(ptr);
+        return;
+    }
+
+    *static_cast<void**>(ptr) = eventPool.head;
+    eventPool.head = ptr;
+    ++eventPool.count;
+}
+
+ALEEventProcessor::ALEEventProcessor(ALE** _E, WorldObject* _obj) : expired(NULL), wheelTime(0), eventCount(0), m_time(0), obj(_obj), E(_E)
 {
     // can be called from multiple threads
     if (obj)
@@ -26,9 +83,13 @@ ALEEventProcessor::ALEEventProcessor(ALE** _E, WorldObject* _obj) : m_time(0), o
 
 ALEEventProcessor::~ALEEventProcessor()
 {
+    // Detached by the EventMgr of a state that no longer exists
+    if (!E)
+        return;
+
     // can be called from multiple threads
     {
-        LOCK_ALE;
+        ALE::Guard guard((*E)->GetStateLock());
         RemoveEvents_internal();
     }
 
@@ -42,54 +103,175 @@ ALEEventProcessor::~ALEEventProcessor()
 void ALEEventProcessor::Update(uint32 diff)
 {
     m_time += diff;
-    for (EventList::iterator it = eventList.begin(); it != eventList.end() && it->first <= m_time; it = eventList.begin())
+
+    while (wheelTime <= m_time)
     {
-        LuaEvent* luaEvent = it->second;
-        eventList.erase(it);
+        // Nothing to run, the wheel can skip ahead
+        if (!eventCount)
+        {
+            wheelTime = m_time + 1;
+            break;
+        }
 
-        if (luaEvent->state != LUAEVENT_STATE_ERASE)
-            eventMap.erase(luaEvent->funcRef);
+        uint32 slot = wheelTime & WHEEL_MASK;
+        if (!slot)
+            Cascade();
 
-        if (luaEvent->state == LUAEVENT_STATE_RUN)
+        WheelLevel* level = wheel[0].get();
+        if (!level || !(level->occupied >> slot))
         {
-            uint32 delay = luaEvent->delay;
-            bool remove = luaEvent->repeats == 1;
-            if (!remove)
-                AddEvent(luaEvent); // Reschedule before calling incase RemoveEvents used
+            // Nothing left on the lowest level this round, skip to the next one
+            wheelTime = std::min<uint64>((wheelTime | WHEEL_MASK) + 1, m_time + 1);
+            continue;
+        }
 
-            // Call the timed event
-            (*E)->OnTimedEvent(luaEvent->funcRef, delay, luaEvent->repeats ? luaEvent->repeats-- : luaEvent->repeats, obj);
+        if (!(level->occupied & (uint64(1) << slot)))
+        {
+            ++wheelTime;
+            continue;
+        }
 
-            if (!remove)
-                continue;
+        // Reverse the slot's list so the events are called in the order they were added
+        LuaEvent* list = TakeSlot(0, slot);
+        while (list)
+        {
+            LuaEvent* luaEvent = list;
+            list = luaEvent->next;
+            luaEvent->next = expired;
+            expired = luaEvent;
         }
 
-        // Event should be deleted (executed last time or set to be aborted)
-        RemoveEvent(luaEvent);
+        // Events rescheduled while calling the expired ones are put on later ticks
+        ++wheelTime;
+
+        while (LuaEvent* luaEvent = expired)
+        {
+            expired = luaEvent->next;
+            luaEvent->next = NULL;
+
+            if (luaEvent->state != LUAEVENT_STATE_ERASE)
+                eventMap.erase(luaEvent->funcRef);
+
+            if (luaEvent->state == LUAEVENT_STATE_RUN)
+            {
+                uint32 delay = luaEvent->delay;
+                bool remove = luaEvent->repeats == 1;
+                if (!remove)
+                    AddEvent(luaEvent); // Reschedule before calling incase RemoveEvents used
+
+                // Call the timed event
+                (*E)->OnTimedEvent(luaEvent->funcRef, delay, luaEvent->repeats ? luaEvent->repeats-- : luaEvent->repeats, obj);
+
+                if (!remove)
+                    continue;
+            }
+
+            // Event should be deleted (executed last time or set to be aborted)
+            RemoveEvent(luaEvent);
+        }
+    }
+}
+
+void ALEEventProcessor::Schedule(LuaEvent* luaEvent)
+{
+    uint64 expireTime = std::max(luaEvent->expireTime, wheelTime);
+    uint64 delta = expireTime - wheelTime;
+
+    uint32 level = 0;
+    while (level < WHEEL_LEVELS - 1 && delta >= (uint64(1) << (WHEEL_BITS * (level + 1))))
+        ++level;
+
+    uint32 slot;
+    if (delta >= (uint64(1) << (WHEEL_BITS * WHEEL_LEVELS)))
+        // Beyond the wheel, park it on the top level slot reached last, it is rescheduled from there
+        slot = ((wheelTime >> (WHEEL_BITS * level)) + WHEEL_MASK) & WHEEL_MASK;
+    else
+        slot = (expireTime >> (WHEEL_BITS * level)) & WHEEL_MASK;
+
+    if (!wheel[level])
+        wheel[level].reset(new WheelLevel());
+
+    WheelLevel* wheelLevel = wheel[level].get();
+    luaEvent->next = wheelLevel->slots[slot];
+    wheelLevel->slots[slot] = luaEvent;
+    wheelLevel->occupied |= uint64(1) << slot;
+    ++eventCount;
+}
+
+void ALEEventProcessor::Cascade()
+{
+    // Called when the lowest level wraps around, find the highest level wrapping around with it
+    uint32 top = 1;
+    while (top < WHEEL_LEVELS - 1 && !((wheelTime >> (WHEEL_BITS * top)) & WHEEL_MASK))
+        ++top;
+
+    // Move the events of the current slots down, starting from the top so they can fall through
+    for (uint32 level = top; level > 0; --level)
+    {
+        LuaEvent* list = TakeSlot(level, (wheelTime >> (WHEEL_BITS * level)) & WHEEL_MASK);
+        while (list)
+        {
+            LuaEvent* luaEvent = list;
+            list = luaEvent->next;
+            Schedule(luaEvent);
+        }
+    }
+}
+
+LuaEvent* ALEEventProcessor::TakeSlot(uint32 level, uint32 slot)
+{
+    WheelLevel* wheelLevel = wheel[level].get();
+    if (!wheelLevel || !(wheelLevel->occupied & (uint64(1) << slot)))
+        return NULL;
+
+    LuaEvent* list = wheelLevel->slots[slot];
+    wheelLevel->slots[slot] = NULL;
+    wheelLevel->occupied &= ~(uint64(1) << slot);
+
+    for (LuaEvent* luaEvent = list; luaEvent; luaEvent = luaEvent->next)
+        --eventCount;
+    return list;
+}
+
+template<typename F>
+void ALEEventProcessor::ForEachEvent(F f)
+{
+    for (LuaEvent* luaEvent = expired; luaEvent; luaEvent = luaEvent->next)
+        f(luaEvent);
+
+    for (std::unique_ptr<WheelLevel>& level : wheel)
+    {
+        if (!level || !level->occupied)
+            continue;
+
+        for (LuaEvent* slot : level->slots)
+            for (LuaEvent* luaEvent = slot; luaEvent; luaEvent = luaEvent->next)
+                f(luaEvent);
     }
 }
 
 void ALEEventProcessor::SetStates(LuaEventState state)
 {
-    for (EventList::iterator it = eventList.begin(); it != eventList.end(); ++it)
-        it->second->SetState(state);
+    ForEachEvent([state](LuaEvent* luaEvent) { luaEvent->SetState(state); });
     if (state == LUAEVENT_STATE_ERASE)
         eventMap.clear();
 }
 
 void ALEEventProcessor::RemoveEvents_internal()
 {
-    //if (!final)
-    //{
-    //    for (EventList::iterator it = eventList.begin(); it != eventList.end(); ++it)
-    //        it->second->to_Abort = true;
-    //    return;
-    //}
+    // Unlink everything first, RemoveEvent frees the events
+    std::vector<LuaEvent*> events;
+    events.reserve(eventCount);
+    ForEachEvent([&events](LuaEvent* luaEvent) { events.push_back(luaEvent); });
+
+    expired = NULL;
+    for (std::unique_ptr<WheelLevel>& level : wheel)
+        level.reset();
+    eventCount = 0;
 
-    for (EventList::iterator it = eventList.begin(); it != eventList.end(); ++it)
-        RemoveEvent(it->second);
+    for (LuaEvent* luaEvent : events)
+        RemoveEvent(luaEvent);
 
-    eventList.clear();
     eventMap.clear();
 }
 
@@ -104,17 +286,23 @@ void ALEEventProcessor::SetState(int eventId, LuaEventState state)
 void ALEEventProcessor::AddEvent(LuaEvent* luaEvent)
 {
     luaEvent->GenerateDelay();
-    eventList.insert(std::pair<uint64, LuaEvent*>(m_time + luaEvent->delay, luaEvent));
+    luaEvent->expireTime = m_time + luaEvent->delay;
+    Schedule(luaEvent);
     eventMap[luaEvent->funcRef] = luaEvent;
 }
 
 void ALEEventProcessor::AddEvent(int funcRef, uint32 min, uint32 max, uint32 repeats)
 {
     AddEvent(new LuaEvent(funcRef, min, max, repeats));
+    (*E)->eventMgr->AddEventOwner(funcRef, this);
 }
 
 void ALEEventProcessor::RemoveEvent(LuaEvent* luaEvent)
 {
+    // Erased events were already dropped from the owner index by EventMgr::SetStates
+    if (luaEvent->state != LUAEVENT_STATE_ERASE)
+        (*E)->eventMgr->RemoveEventOwner(luaEvent->funcRef, this);
+
     // Unreference if should and if ALE was not yet uninitialized and if the lua state still exists
     if (luaEvent->state != LUAEVENT_STATE_ERASE && ALE::IsInitialized() && (*E)->HasLuaState())
     {
@@ -132,10 +320,15 @@ EventMgr::~EventMgr()
 {
     {
         Guard guard(GetLock());
+        // Processors can outlive their state, they are detached so they don't access it after this
         if (!processors.empty())
             for (ProcessorSet::const_iterator it = processors.begin(); it != processors.end(); ++it) // loop processors
+            {
                 (*it)->RemoveEvents_internal();
+                (*it)->E = NULL;
+            }
         globalProcessor->RemoveEvents_internal();
+        globalProcessor->E = NULL;
     }
     delete globalProcessor;
     globalProcessor = NULL;
@@ -146,15 +339,36 @@ void EventMgr::SetStates(LuaEventState state)
     Guard guard(GetLock());
     if (!processors.empty())
         for (ProcessorSet::const_iterator it = processors.begin(); it != processors.end(); ++it) // loop processors
-            (*it)->SetStates(state);
+            if ((*it)->HasEvents())
+                (*it)->SetStates(state);
     globalProcessor->SetStates(state);
+
+    // Erased events are not removed from the processors through RemoveEvent
+    if (state == LUAEVENT_STATE_ERASE)
+    {
+        std::lock_guard<std::mutex> ownersGuard(eventOwnersLock);
+        eventOwners.clear();
+    }
 }
 
 void EventMgr::SetState(int eventId, LuaEventState state)
 {
-    Guard guard(GetLock());
-    if (!processors.empty())
-        for (ProcessorSet::const_iterator it = processors.begin(); it != processors.end(); ++it) // loop processors
-            (*it)->SetState(eventId, state);
-    globalProcessor->SetState(eventId, state);
+    std::lock_guard<std::mutex> ownersGuard(eventOwnersLock);
+    auto itr = eventOwners.find(eventId);
+    if (itr != eventOwners.end())
+        itr->second->SetState(eventId, state);
+}
+
+void EventMgr::AddEventOwner(int eventId, ALEEventProcessor* processor)
+{
+    std::lock_guard<std::mutex> ownersGuard(eventOwnersLock);
+    eventOwners[eventId] = processor;
+}
+
+void EventMgr::RemoveEventOwner(int eventId, ALEEventProcessor* processor)
+{
+    std::lock_guard<std::mutex> ownersGuard(eventOwnersLock);
+    auto itr = eventOwners.find(eventId);
+    if (itr != eventOwners.end() && itr->second == processor)
+        eventOwners.erase(itr);
 }
@@ -10,7 +10,8 @@
 #include "ALEUtility.h"
 #include "Common.h"
 #include "Util.h"
-#include <map>
+#include <memory>
+#include <mutex>
 
 #include "Define.h"
 
@@ -29,10 +30,14 @@ enum LuaEventState
 struct LuaEvent
 {
     LuaEvent(int _funcRef, uint32 _min, uint32 _max, uint32 _repeats) :
-        min(_min), max(_max), delay(0), repeats(_repeats), funcRef(_funcRef), state(LUAEVENT_STATE_RUN)
+        min(_min), max(_max), delay(0), repeats(_repeats), funcRef(_funcRef), state(LUAEVENT_STATE_RUN), expireTime(0), next(NULL)
     {
     }
 
+    // Events are created and destroyed constantly, freed events are kept for reuse
+    static void* operator new(size_t size);
+    static void operator delete(void* ptr);
+
     void SetState(LuaEventState _state)
     {
         if (state != LUAEVENT_STATE_ERASE)
@@ -50,6 +55,8 @@ struct LuaEvent
     uint32 repeats; // Amount of repeats to make, 0 for infinite
     int funcRef;    // Lua function reference ID, also used as event ID
     LuaEventState state;    // State for next call
+    uint64 expireTime;  // Processor time at which the event is called
+    LuaEvent* next;     // Next event in the same timer wheel slot
 };
 
 class ALEEventProcessor
@@ -57,7 +64,6 @@ class ALEEventProcessor
     friend class EventMgr;
 
 public:
-    typedef std::multimap<uint64, LuaEvent*> EventList;
     typedef std::unordered_map<int, LuaEvent*> EventMap;
 
     ALEEventProcessor(ALE** _E, WorldObject* _obj);
@@ -69,13 +75,54 @@ public:
     // set the event to be removed when executing
     void SetState(int eventId, LuaEventState state);
     void AddEvent(int funcRef, uint32 min, uint32 max, uint32 repeats);
+    // Returns true if timed events of this processor are run in the given state
+    bool IsOwnedBy(ALE const* owner) const { return E && *E == owner; }
+    bool HasEvents() const { return eventCount || expired; }
     EventMap eventMap;
 
 private:
+    /*
+     * Events are kept in a hierarchical timer wheel with millisecond ticks.
+     *
+     * Level N has WHEEL_SLOTS slots of WHEEL_SLOTS^N ticks each. Events are put on the lowest
+     *   level that reaches their expire time and move down a level each time the level below
+     *   wraps around, so inserting and expiring an event does not depend on the amount of events.
+     *   Levels are allocated on first use as most processors only have short timers.
+     */
+    static constexpr uint32 WHEEL_BITS = 6;
+    static constexpr uint32 WHEEL_SLOTS = 1 << WHEEL_BITS;
+    static constexpr uint32 WHEEL_MASK = WHEEL_SLOTS - 1;
+    static constexpr uint32 WHEEL_LEVELS = 4;
+
+    struct WheelLevel
+    {
+        WheelLevel() : occupied(0)
+        {
+            for (LuaEvent*& slot : slots)
+                slot = NULL;
+        }
+
+        // Singly linked lists of events, newest first
+        LuaEvent* slots[WHEEL_SLOTS];
+        // Bit per non empty slot
+        uint64 occupied;
+    };
+
     void RemoveEvents_internal();
     void AddEvent(LuaEvent* luaEvent);
     void RemoveEvent(LuaEvent* luaEvent);
-    EventList eventList;
+    void Schedule(LuaEvent* luaEvent);
+    void Cascade();
+    LuaEvent* TakeSlot(uint32 level, uint32 slot);
+    template<typename F> void ForEachEvent(F f);
+
+    std::unique_ptr<WheelLevel> wheel[WHEEL_LEVELS];
+    // Events of the tick being run, in call order
+    LuaEvent* expired;
+    // Next tick of the wheel to run
+    uint64 wheelTime;
+    // Amount of events in the wheel
+    uint32 eventCount;
     uint64 m_time;
     WorldObject* obj;
     ALE** E;
@@ -99,6 +146,15 @@ public:
     // Sets the eventId's state in all processors
     // Execute only in safe env
     void SetState(int eventId, LuaEventState state);
+
+    void AddEventOwner(int eventId, ALEEventProcessor* processor);
+    void RemoveEventOwner(int eventId, ALEEventProcessor* processor);
+
+private:
+    // Event ID -> processor running the event, lets SetState go directly to the right processor
+    std::unordered_map<int, ALEEventProcessor*> eventOwners;
+    // Separate from the processor set lock as events are removed while it is held
+    std::mutex eventOwnersLock;
 };
 
 #endif
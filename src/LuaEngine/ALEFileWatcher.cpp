@@ -9,8 +9,25 @@
 #include "ALEUtility.h"
 #include <boost/filesystem.hpp>
 
+#ifdef ALE_FILE_WATCHER_INOTIFY
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+// Events are collected until the folder has been quiet for this long, so saving many files reloads once
+static constexpr std::chrono::milliseconds INOTIFY_DEBOUNCE(200);
+// How often the watcher thread checks whether it should stop
+static constexpr int INOTIFY_POLL_TIMEOUT_MS = 100;
+static constexpr uint32 INOTIFY_WATCH_MASK = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO;
+#endif
+
 ALEFileWatcher::ALEFileWatcher() : running(false), checkInterval(1)
 {
+#ifdef ALE_FILE_WATCHER_INOTIFY
+    inotifyFd = -1;
+#endif
 }
 
 ALEFileWatcher::~ALEFileWatcher()
@@ -36,6 +53,15 @@ void ALEFileWatcher::StartWatching(const std::string& scriptPath, uint32 interva
     checkInterval = intervalSeconds;
     running.store(true);
 
+#ifdef ALE_FILE_WATCHER_INOTIFY
+    if (StartInotify())
+    {
+        watcherThread = std::thread(&ALEFileWatcher::WatchLoop, this);
+        ALE_LOG_INFO("[ALEFileWatcher]: Started watching '{}' (inotify, {} folders)", watchPath, inotifyWatches.size());
+        return;
+    }
+#endif
+
     ScanDirectory(watchPath);
 
     watcherThread = std::thread(&ALEFileWatcher::WatchLoop, this);
@@ -53,6 +79,15 @@ void ALEFileWatcher::StopWatching()
     if (watcherThread.joinable())
         watcherThread.join();
 
+#ifdef ALE_FILE_WATCHER_INOTIFY
+    if (inotifyFd >= 0)
+    {
+        close(inotifyFd);
+        inotifyFd = -1;
+    }
+    inotifyWatches.clear();
+#endif
+
     fileTimestamps.clear();
     
     ALE_LOG_INFO("[ALEFileWatcher]: Stopped watching files");
@@ -60,6 +95,14 @@ void ALEFileWatcher::StopWatching()
 
 void ALEFileWatcher::WatchLoop()
 {
+#ifdef ALE_FILE_WATCHER_INOTIFY
+    if (inotifyFd >= 0)
+    {
+        InotifyLoop();
+        return;
+    }
+#endif
+
     while (running.load())
     {
         try
@@ -120,6 +163,7 @@ void ALEFileWatcher::ScanDirectory(const std::string& path)
 void ALEFileWatcher::CheckForChanges()
 {
     bool hasChanges = false;
+    std::set<std::string> changedFiles;
     
     try
     {
@@ -132,7 +176,7 @@ void ALEFileWatcher::CheckForChanges()
         
         for (boost::filesystem::directory_iterator dir_iter(dir); dir_iter != end_iter; ++dir_iter)
         {
-            if (ShouldReloadFile(dir_iter->path().generic_string()))
+            if (ShouldReloadFile(dir_iter->path().generic_string(), changedFiles))
                 hasChanges = true;
         }
         
@@ -141,6 +185,7 @@ void ALEFileWatcher::CheckForChanges()
             if (!boost::filesystem::exists(it->first))
             {
                 ALE_LOG_DEBUG("[ALEFileWatcher]: File deleted: {}", it->first);
+                changedFiles.insert(it->first);
                 it = fileTimestamps.erase(it);
                 hasChanges = true;
             }
@@ -158,14 +203,23 @@ void ALEFileWatcher::CheckForChanges()
 
     if (hasChanges)
     {
-        ALE_LOG_INFO("[ALEFileWatcher]: Lua script changes detected - triggering reload");
-        ALE::ReloadALE();
+        TriggerReload(changedFiles);
         
         ScanDirectory(watchPath);
     }
 }
 
-bool ALEFileWatcher::ShouldReloadFile(const std::string& filepath)
+void ALEFileWatcher::TriggerReload(const std::set<std::string>& changedFiles)
+{
+    for (const std::string& filepath : changedFiles)
+        ALE_LOG_DEBUG("[ALEFileWatcher]: Changed: {}", filepath);
+
+    ALE_LOG_INFO("[ALEFileWatcher]: {} Lua script changes detected - triggering reload", changedFiles.size());
+    ALE::ReloadALE(changedFiles);
+}
+
+// Adds the files that changed since the last scan to `changedFiles`, returns true if there were any
+bool ALEFileWatcher::ShouldReloadFile(const std::string& filepath, std::set<std::string>& changedFiles)
 {
     try
     {
@@ -174,13 +228,14 @@ bool ALEFileWatcher::ShouldReloadFile(const std::string& filepath)
         if (boost::filesystem::is_directory(file))
         {
             boost::filesystem::directory_iterator end_iter;
+            bool changed = false;
             
             for (boost::filesystem::directory_iterator dir_iter(file); dir_iter != end_iter; ++dir_iter)
             {
-                if (ShouldReloadFile(dir_iter->path().generic_string()))
-                    return true;
+                if (ShouldReloadFile(dir_iter->path().generic_string(), changedFiles))
+                    changed = true;
             }
-            return false;
+            return changed;
         }
         
         if (!boost::filesystem::is_regular_file(file))
@@ -197,6 +252,7 @@ bool ALEFileWatcher::ShouldReloadFile(const std::string& filepath)
         {
             ALE_LOG_DEBUG("[ALEFileWatcher]: New file detected: {}", filepath);
             fileTimestamps[filepath] = currentTime;
+            changedFiles.insert(filepath);
             return true;
         }
         
@@ -204,6 +260,7 @@ bool ALEFileWatcher::ShouldReloadFile(const std::string& filepath)
         {
             ALE_LOG_DEBUG("[ALEFileWatcher]: File modified: {}", filepath);
             it->second = currentTime;
+            changedFiles.insert(filepath);
             return true;
         }
     }
@@ -214,3 +271,163 @@ bool ALEFileWatcher::ShouldReloadFile(const std::string& filepath)
     
     return false;
 }
+
+#ifdef ALE_FILE_WATCHER_INOTIFY
+bool ALEFileWatcher::StartInotify()
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotifyFd < 0)
+    {
+        ALE_LOG_ERROR("[ALEFileWatcher]: inotify unavailable ({}), scanning for changes instead", strerror(errno));
+        return false;
+    }
+
+    AddInotifyWatch(watchPath, nullptr);
+    if (inotifyWatches.empty())
+    {
+        close(inotifyFd);
+        inotifyFd = -1;
+        return false;
+    }
+    return true;
+}
+
+// Watches `path` and its subfolders, the watched scripts in them are added to `changedFiles` if given
+void ALEFileWatcher::AddInotifyWatch(const std::string& path, std::set<std::string>* changedFiles)
+{
+    int wd = inotify_add_watch(inotifyFd, path.c_str(), INOTIFY_WATCH_MASK);
+    if (wd < 0)
+    {
+        ALE_LOG_ERROR("[ALEFileWatcher]: Could not watch '{}': {}", path, strerror(errno));
+        return;
+    }
+    inotifyWatches[wd] = path;
+
+    try
+    {
+        boost::filesystem::directory_iterator end_iter;
+        for (boost::filesystem::directory_iterator dir_iter(path); dir_iter != end_iter; ++dir_iter)
+        {
+            std::string filename = dir_iter->path().filename().generic_string();
+            if (filename[0] == '.')
+                continue;
+
+            std::string fullpath = dir_iter->path().generic_string();
+            if (boost::filesystem::is_directory(dir_iter->status()))
+                AddInotifyWatch(fullpath, changedFiles);
+            else if (changedFiles && IsWatchedFileType(filename))
+                changedFiles->insert(fullpath);
+        }
+    }
+    catch (const std::exception& e)
+    {
+        ALE_LOG_ERROR("[ALEFileWatcher]: Error scanning directory '{}': {}", path, e.what());
+    }
+}
+
+bool ALEFileWatcher::ReadInotifyEvents(std::set<std::string>& changedFiles)
+{
+    bool complete = true;
+    alignas(inotify_event) char buffer[16 * 1024];
+
+    for (;;)
+    {
+        ssize_t length = read(inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0)
+            break;
+
+        for (char* ptr = buffer; ptr < buffer + length;)
+        {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+            ptr += sizeof(inotify_event) + event->len;
+
+            if (event->mask & IN_Q_OVERFLOW)
+            {
+                complete = false;
+                continue;
+            }
+
+            auto it = inotifyWatches.find(event->wd);
+            if (it == inotifyWatches.end())
+                continue;
+
+            if (event->mask & IN_IGNORED)
+            {
+                inotifyWatches.erase(it);
+                continue;
+            }
+
+            if (!event->len || event->name[0] == '.')
+                continue;
+
+            std::string filename = event->name;
+            // Joined like the directory iterators of GetScripts do, so the paths match even with a trailing slash in ScriptPath
+            std::string fullpath = (boost::filesystem::path(it->second) / filename).generic_string();
+            if (event->mask & IN_ISDIR)
+            {
+                if (event->mask & (IN_CREATE | IN_MOVED_TO))
+                    AddInotifyWatch(fullpath, &changedFiles);
+                else if (event->mask & IN_MOVED_FROM)
+                    complete = false; // The watches below the moved folder now have stale paths
+                else
+                    changedFiles.insert(fullpath);
+                continue;
+            }
+
+            if (IsWatchedFileType(filename))
+                changedFiles.insert(fullpath);
+        }
+    }
+
+    return complete;
+}
+
+void ALEFileWatcher::InotifyLoop()
+{
+    std::set<std::string> changedFiles;
+    bool changesUnknown = false;
+    std::chrono::steady_clock::time_point lastEvent = std::chrono::steady_clock::now();
+
+    while (running.load())
+    {
+        pollfd pfd = { inotifyFd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, INOTIFY_POLL_TIMEOUT_MS);
+        if (ready < 0 && errno != EINTR)
+        {
+            ALE_LOG_ERROR("[ALEFileWatcher]: Error waiting for file changes: {}", strerror(errno));
+            return;
+        }
+
+        if (ready > 0 && (pfd.revents & POLLIN))
+        {
+            if (!ReadInotifyEvents(changedFiles))
+            {
+                // Events were lost or folders moved, watch the tree again and reload everything
+                changesUnknown = true;
+                for (auto& itr : inotifyWatches)
+                    inotify_rm_watch(inotifyFd, itr.first);
+                inotifyWatches.clear();
+                AddInotifyWatch(watchPath, nullptr);
+            }
+            lastEvent = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        if (changedFiles.empty() && !changesUnknown)
+            continue;
+        if (std::chrono::steady_clock::now() - lastEvent < INOTIFY_DEBOUNCE)
+            continue;
+
+        if (changesUnknown)
+        {
+            ALE_LOG_INFO("[ALEFileWatcher]: Lua script changes detected - triggering reload");
+            ALE::ReloadALE();
+        }
+        else
+            TriggerReload(changedFiles);
+
+        changedFiles.clear();
+        changesUnknown = false;
+    }
+}
+#endif
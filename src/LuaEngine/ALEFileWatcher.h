@@ -10,11 +10,18 @@
 #include <thread>
 #include <atomic>
 #include <map>
+#include <set>
 #include <string>
 #include <chrono>
+#include <unordered_map>
 #include <boost/filesystem.hpp>
 #include "Common.h"
 
+// Linux gets notified of changes by the kernel, other platforms scan the script folder
+#ifdef __linux__
+#define ALE_FILE_WATCHER_INOTIFY
+#endif
+
 class ALEFileWatcher
 {
 public:
@@ -29,14 +36,27 @@ private:
     void WatchLoop();
     void ScanDirectory(const std::string& path);
     void CheckForChanges();
-    bool ShouldReloadFile(const std::string& filepath);
+    bool ShouldReloadFile(const std::string& filepath, std::set<std::string>& changedFiles);
     bool IsWatchedFileType(const std::string& filename);
+    void TriggerReload(const std::set<std::string>& changedFiles);
+
+#ifdef ALE_FILE_WATCHER_INOTIFY
+    bool StartInotify();
+    void InotifyLoop();
+    void AddInotifyWatch(const std::string& path, std::set<std::string>* changedFiles);
+    // Returns false if events were lost and the changes are unknown
+    bool ReadInotifyEvents(std::set<std::string>& changedFiles);
+
+    int inotifyFd;
+    // Watch descriptor -> watched directory
+    std::unordered_map<int, std::string> inotifyWatches;
+#endif
 
     std::thread watcherThread;
     std::atomic<bool> running;
     std::string watchPath;
     uint32 checkInterval;
-    
+
     std::map<std::string, std::time_t> fileTimestamps;
 };
 
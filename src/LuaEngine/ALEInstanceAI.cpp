@@ -11,21 +11,21 @@
 
 void ALEInstanceAI::Initialize()
 {
-    LOCK_ALE;
+    ALE::Guard guard(E->GetStateLock());
 
-    ASSERT(!sALE->HasInstanceData(instance));
+    ASSERT(!E->HasInstanceData(instance));
 
     // Create a new table for instance data.
-    lua_State* L = sALE->L;
+    lua_State* L = E->L;
     lua_newtable(L);
-    sALE->CreateInstanceData(instance);
+    E->CreateInstanceData(instance);
 
-    sALE->OnInitialize(this);
+    E->OnInitialize(this);
 }
 
 void ALEInstanceAI::Load(const char* data)
 {
-    LOCK_ALE;
+    ALE::Guard guard(E->GetStateLock());
 
     // If we get passed NULL (i.e. `Reload` was called) then use
     //   the last known save data (or maybe just an empty string).
@@ -40,21 +40,21 @@ void ALEInstanceAI::Load(const char* data)
 
     if (data[0] == '\0')
     {
-        ASSERT(!sALE->HasInstanceData(instance));
+        ASSERT(!E->HasInstanceData(instance));
 
         // Create a new table for instance data.
-        lua_State* L = sALE->L;
+        lua_State* L = E->L;
         lua_newtable(L);
-        sALE->CreateInstanceData(instance);
+        E->CreateInstanceData(instance);
 
-        sALE->OnLoad(this);
+        E->OnLoad(this);
         // Stack: (empty)
         return;
     }
 
     size_t decodedLength;
     const unsigned char* decodedData = ALEUtil::DecodeData(data, &decodedLength);
-    lua_State* L = sALE->L;
+    lua_State* L = E->L;
 
     if (decodedData)
     {
@@ -71,9 +71,9 @@ void ALEInstanceAI::Load(const char* data)
             // Only use the data if it's a table.
             if (lua_istable(L, -1))
             {
-                sALE->CreateInstanceData(instance);
+                E->CreateInstanceData(instance);
                 // Stack: (empty)
-                sALE->OnLoad(this);
+                E->OnLoad(this);
                 // WARNING! lastSaveData might be different after `OnLoad` if the Lua code saved data.
             }
             else
@@ -107,8 +107,8 @@ void ALEInstanceAI::Load(const char* data)
 
 const char* ALEInstanceAI::Save() const
 {
-    LOCK_ALE;
-    lua_State* L = sALE->L;
+    ALE::Guard guard(E->GetStateLock());
+    lua_State* L = E->L;
     // Stack: (empty)
 
     /*
@@ -121,7 +121,7 @@ const char* ALEInstanceAI::Save() const
     ALEInstanceAI* self = const_cast<ALEInstanceAI*>(this);
 
     lua_pushcfunction(L, mar_encode);
-    sALE->PushInstanceData(L, self, false);
+    E->PushInstanceData(L, self, false);
     // Stack: mar_encode, instance_data
 
     if (lua_pcall(L, 1, 1, 0) != 0)
@@ -145,11 +145,11 @@ const char* ALEInstanceAI::Save() const
 
 uint32 ALEInstanceAI::GetData(uint32 key) const
 {
-    LOCK_ALE;
-    lua_State* L = sALE->L;
+    ALE::Guard guard(E->GetStateLock());
+    lua_State* L = E->L;
     // Stack: (empty)
 
-    sALE->PushInstanceData(L, const_cast<ALEInstanceAI*>(this), false);
+    E->PushInstanceData(L, const_cast<ALEInstanceAI*>(this), false);
     // Stack: instance_data
 
     ALE::Push(L, key);
@@ -167,11 +167,11 @@ uint32 ALEInstanceAI::GetData(uint32 key) const
 
 void ALEInstanceAI::SetData(uint32 key, uint32 value)
 {
-    LOCK_ALE;
-    lua_State* L = sALE->L;
+    ALE::Guard guard(E->GetStateLock());
+    lua_State* L = E->L;
     // Stack: (empty)
 
-    sALE->PushInstanceData(L, this, false);
+    E->PushInstanceData(L, this, false);
     // Stack: instance_data
 
     ALE::Push(L, key);
@@ -187,11 +187,11 @@ void ALEInstanceAI::SetData(uint32 key, uint32 value)
 
 uint64 ALEInstanceAI::GetData64(uint32 key) const
 {
-    LOCK_ALE;
-    lua_State* L = sALE->L;
+    ALE::Guard guard(E->GetStateLock());
+    lua_State* L = E->L;
     // Stack: (empty)
 
-    sALE->PushInstanceData(L, const_cast<ALEInstanceAI*>(this), false);
+    E->PushInstanceData(L, const_cast<ALEInstanceAI*>(this), false);
     // Stack: instance_data
 
     ALE::Push(L, key);
@@ -209,11 +209,11 @@ uint64 ALEInstanceAI::GetData64(uint32 key) const
 
 void ALEInstanceAI::SetData64(uint32 key, uint64 value)
 {
-    LOCK_ALE;
-    lua_State* L = sALE->L;
+    ALE::Guard guard(E->GetStateLock());
+    lua_State* L = E->L;
     // Stack: (empty)
 
-    sALE->PushInstanceData(L, this, false);
+    E->PushInstanceData(L, this, false);
     // Stack: instance_data
 
     ALE::Push(L, key);
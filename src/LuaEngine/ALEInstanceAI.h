@@ -56,7 +56,12 @@ private:
     std::string lastSaveData;
 
 public:
-    ALEInstanceAI(Map* map) : InstanceData(map)
+    // The state that created the AI, the state of the map when multistate is enabled
+    ALE* E;
+    // Timers of the update handlers registered with an interval
+    ALEUpdateTimers updateTimers;
+
+    ALEInstanceAI(Map* map, ALE* _E) : InstanceData(map), E(_E)
     {
     }
 
@@ -103,30 +108,30 @@ public:
         // If ALE is reloaded, it will be missing our instance data.
         // Reload here instead of waiting for the next hook call (possibly never).
         // This avoids having to have an empty Update hook handler just to trigger the reload.
-        if (!sALE->HasInstanceData(instance))
+        if (!E->HasInstanceData(instance))
             Reload();
 
-        sALE->OnUpdateInstance(this, diff);
+        E->OnUpdateInstance(this, diff);
     }
 
     bool IsEncounterInProgress() const override
     {
-        return sALE->OnCheckEncounterInProgress(const_cast<ALEInstanceAI*>(this));
+        return E->OnCheckEncounterInProgress(const_cast<ALEInstanceAI*>(this));
     }
 
     void OnPlayerEnter(Player* player) override
     {
-        sALE->OnPlayerEnterInstance(this, player);
+        E->OnPlayerEnterInstance(this, player);
     }
 
     void OnGameObjectCreate(GameObject* gameobject) override
     {
-        sALE->OnGameObjectCreate(this, gameobject);
+        E->OnGameObjectCreate(this, gameobject);
     }
 
     void OnCreatureCreate(Creature* creature) override
     {
-        sALE->OnCreatureCreate(this, creature);
+        E->OnCreatureCreate(this, creature);
     }
 };
 
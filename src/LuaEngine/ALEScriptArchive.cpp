@@ -0,0 +1,188 @@
+/*
+* Copyright (C) 2010 - 2025 Eluna Lua Engine <https://elunaluaengine.github.io/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+#include "ALEScriptArchive.h"
+#include "ALEUtility.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+#if AC_PLATFORM == AC_PLATFORM_WINDOWS
+#include <fstream>
+#include <iterator>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+extern "C"
+{
+#include "lua.h"
+#include "lauxlib.h"
+};
+
+static const char ARCHIVE_MAGIC[] = "ALEPACK 1\n";
+
+ALEScriptArchive::ALEScriptArchive() : data(nullptr), size(0)
+{
+}
+
+ALEScriptArchive::~ALEScriptArchive()
+{
+    Close();
+}
+
+bool ALEScriptArchive::Open(const std::string& archivePath)
+{
+    Close();
+    path = archivePath;
+
+#if AC_PLATFORM == AC_PLATFORM_WINDOWS
+    std::ifstream file(archivePath, std::ios::binary);
+    if (!file.is_open())
+    {
+        ALE_LOG_ERROR("[ALE]: Could not open script archive `{}`", archivePath);
+        return false;
+    }
+    buffer.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    data = buffer.data();
+    size = buffer.size();
+#else
+    int fd = open(archivePath.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        ALE_LOG_ERROR("[ALE]: Could not open script archive `{}`", archivePath);
+        return false;
+    }
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0)
+    {
+        close(fd);
+        ALE_LOG_ERROR("[ALE]: Script archive `{}` is empty", archivePath);
+        return false;
+    }
+
+    size = static_cast<size_t>(fileInfo.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+    {
+        size = 0;
+        ALE_LOG_ERROR("[ALE]: Could not map script archive `{}`", archivePath);
+        return false;
+    }
+    data = static_cast<const char*>(mapping);
+#endif
+
+    size_t magicLength = sizeof(ARCHIVE_MAGIC) - 1;
+    if (size < magicLength || memcmp(data, ARCHIVE_MAGIC, magicLength) != 0)
+    {
+        ALE_LOG_ERROR("[ALE]: `{}` is not a script archive", archivePath);
+        Close();
+        return false;
+    }
+
+    // Read the index, the offsets follow from the sizes as the contents are stored back to back
+    std::vector<std::pair<std::string, size_t>> index;
+    size_t pos = magicLength;
+    for (;;)
+    {
+        const char* lineEnd = static_cast<const char*>(memchr(data + pos, '\n', size - pos));
+        if (!lineEnd)
+        {
+            ALE_LOG_ERROR("[ALE]: Script archive `{}` has a truncated index", archivePath);
+            Close();
+            return false;
+        }
+
+        std::string line(data + pos, lineEnd);
+        pos = lineEnd - data + 1;
+        if (line.empty())
+            break;
+
+        std::size_t tab = line.find('\t');
+        if (tab == std::string::npos || tab == 0)
+        {
+            ALE_LOG_ERROR("[ALE]: Script archive `{}` has an invalid index line `{}`", archivePath, line);
+            Close();
+            return false;
+        }
+        index.emplace_back(line.substr(0, tab), std::strtoull(line.c_str() + tab + 1, nullptr, 10));
+    }
+
+    for (auto& item : index)
+    {
+        if (item.second > size - pos)
+        {
+            ALE_LOG_ERROR("[ALE]: Script archive `{}` is truncated at `{}`", archivePath, item.first);
+            Close();
+            return false;
+        }
+
+        entries.push_back({ std::move(item.first), data + pos, item.second });
+        pos += item.second;
+    }
+
+    IndexModules();
+    return true;
+}
+
+void ALEScriptArchive::Close()
+{
+#if AC_PLATFORM == AC_PLATFORM_WINDOWS
+    buffer.clear();
+    buffer.shrink_to_fit();
+#else
+    if (data)
+        munmap(const_cast<char*>(data), size);
+#endif
+    data = nullptr;
+    size = 0;
+    entries.clear();
+    modules.clear();
+}
+
+void ALEScriptArchive::IndexModules()
+{
+    // Every folder of the archive acts as a require path, the first match wins like in package.path
+    static const char* const moduleExtensions[] = { ".lua", ".ext", ".out" };
+    for (const char* ext : moduleExtensions)
+    {
+        size_t extLength = strlen(ext);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            const std::string& entryPath = entries[i].path;
+            if (entryPath.length() <= extLength || entryPath.compare(entryPath.length() - extLength, extLength, ext) != 0)
+                continue;
+
+            std::string module = entryPath.substr(0, entryPath.length() - extLength);
+            modules.emplace(module, i);
+
+            for (std::size_t slash = module.find('/'); slash != std::string::npos; slash = module.find('/', slash + 1))
+                modules.emplace(module.substr(slash + 1), i);
+        }
+    }
+}
+
+const ALEScriptArchive::Entry* ALEScriptArchive::FindModule(const std::string& name) const
+{
+    std::string module = name;
+    std::replace(module.begin(), module.end(), '.', '/');
+
+    auto it = modules.find(module);
+    if (it == modules.end())
+        return nullptr;
+    return &entries[it->second];
+}
+
+int ALEScriptArchive::Load(lua_State* L, const Entry& entry) const
+{
+    std::string chunkname = "@" + path + "/" + entry.path;
+    return luaL_loadbuffer(L, entry.data, entry.size, chunkname.c_str());
+}
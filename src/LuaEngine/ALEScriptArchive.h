@@ -0,0 +1,67 @@
+/*
+* Copyright (C) 2010 - 2025 Eluna Lua Engine <https://elunaluaengine.github.io/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+#ifndef ALE_SCRIPT_ARCHIVE_H
+#define ALE_SCRIPT_ARCHIVE_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "Common.h"
+
+struct lua_State;
+
+/*
+ * A read-only pack of scripts in a single file, made with `tools/ale_pack.lua`.
+ *
+ * The file is memory-mapped and scripts are loaded straight from the mapping,
+ *   so a deploy with thousands of scripts costs one open instead of one per file.
+ *
+ * Format:
+ *   ALEPACK 1\n
+ *   <path>\t<size>\n     one line per script, path relative to the packed folder using '/'
+ *   \n
+ *   <contents of every script, in index order>
+ */
+class ALEScriptArchive
+{
+public:
+    struct Entry
+    {
+        std::string path;
+        const char* data;
+        size_t size;
+    };
+
+    ALEScriptArchive();
+    ~ALEScriptArchive();
+
+    bool Open(const std::string& archivePath);
+    void Close();
+    bool IsOpen() const { return data != nullptr; }
+
+    const std::string& GetPath() const { return path; }
+    const std::vector<Entry>& GetEntries() const { return entries; }
+
+    // Finds the script `require(name)` resolves to, like a `?.lua;?.ext;?.out` path for every packed folder
+    const Entry* FindModule(const std::string& name) const;
+    int Load(lua_State* L, const Entry& entry) const;
+
+private:
+    void IndexModules();
+
+    std::string path;
+    const char* data;
+    size_t size;
+#if AC_PLATFORM == AC_PLATFORM_WINDOWS
+    std::vector<char> buffer;
+#endif
+
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, size_t> modules;
+};
+
+#endif
@@ -18,6 +18,8 @@ extern "C"
 #include "ALEUtility.h"
 #include "SharedDefines.h"
 
+#include <new>
+
 class ALEGlobal
 {
 public:
@@ -55,24 +57,74 @@ public:
     }
 };
 
+class Object;
+class WorldObject;
+class Unit;
+class Player;
+class Creature;
+class GameObject;
+class Corpse;
+class Item;
+
+// Bits of the game object class hierarchy, an object's mask has its own bit and the bits of its base classes
+enum ALETypeMask : uint32
+{
+    ALE_TYPEMASK_OBJECT         = 0x01,
+    ALE_TYPEMASK_WORLDOBJECT    = 0x02,
+    ALE_TYPEMASK_UNIT           = 0x04,
+    ALE_TYPEMASK_PLAYER         = 0x08,
+    ALE_TYPEMASK_CREATURE       = 0x10,
+    ALE_TYPEMASK_GAMEOBJECT     = 0x20,
+    ALE_TYPEMASK_CORPSE         = 0x40,
+    ALE_TYPEMASK_ITEM           = 0x80
+};
+
+template<typename T> struct ALETypeTraits { static constexpr uint32 mask = 0; };
+template<> struct ALETypeTraits<Object> { static constexpr uint32 mask = ALE_TYPEMASK_OBJECT; };
+template<> struct ALETypeTraits<WorldObject> { static constexpr uint32 mask = ALE_TYPEMASK_WORLDOBJECT | ALETypeTraits<Object>::mask; };
+template<> struct ALETypeTraits<Unit> { static constexpr uint32 mask = ALE_TYPEMASK_UNIT | ALETypeTraits<WorldObject>::mask; };
+template<> struct ALETypeTraits<Player> { static constexpr uint32 mask = ALE_TYPEMASK_PLAYER | ALETypeTraits<Unit>::mask; };
+template<> struct ALETypeTraits<Creature> { static constexpr uint32 mask = ALE_TYPEMASK_CREATURE | ALETypeTraits<Unit>::mask; };
+template<> struct ALETypeTraits<GameObject> { static constexpr uint32 mask = ALE_TYPEMASK_GAMEOBJECT | ALETypeTraits<WorldObject>::mask; };
+template<> struct ALETypeTraits<Corpse> { static constexpr uint32 mask = ALE_TYPEMASK_CORPSE | ALETypeTraits<WorldObject>::mask; };
+template<> struct ALETypeTraits<Item> { static constexpr uint32 mask = ALE_TYPEMASK_ITEM | ALETypeTraits<Object>::mask; };
+
 class ALEObject
 {
 public:
     template<typename T>
-    ALEObject(T * obj, bool manageMemory);
+    ALEObject(ALE* _E, T * obj, bool manageMemory);
 
     ~ALEObject()
     {
     }
 
+    // Key of the class metatables holding GetMetatableMarker(), set by ALETemplate::Register
+    static constexpr int METATABLE_MARKER_KEY = 1;
+    // Tells the metatables of ALE objects from those of other userdata, Lua code can't create it
+    static void* GetMetatableMarker()
+    {
+        static const char marker = 0;
+        return const_cast<char*>(&marker);
+    }
+
     // Get wrapped object pointer
     void* GetObj() const { return object; }
     // Returns whether the object is valid or not
-    bool IsValid() const { return !callstackid || callstackid == sALE->GetCallstackId(); }
+    bool IsValid() const { return !callstackid || callstackid == E->GetCallstackId(); }
     // Returns whether the object can be invalidated or not
     bool CanInvalidate() const { return _invalidate; }
     // Returns pointer to the wrapped object's type name
     const char* GetTypeName() const { return type_name; }
+    // Returns the ALETypeMask bits of the wrapped object's class, 0 for classes outside the game object hierarchy
+    uint32 GetTypeMask() const { return type_mask; }
+    // Returns whether the object is a read only view of an object owned by the core
+    bool IsView() const { return view; }
+    // Returns the read position of a view, views are read without moving the viewed object's own position
+    uint32 GetViewPosition() const { return viewPosition; }
+    void SetViewPosition(uint32 position) { viewPosition = position; }
+    // Returns whether the object was pushed during the given call stack and will be invalidated at its end
+    bool BelongsToCallstack(uint64 id) const { return _invalidate && callstackid == id; }
 
     // Sets the object pointer that is wrapped
     void SetObj(void* obj)
@@ -87,12 +139,27 @@ public:
         ASSERT(!valid || (valid && object));
         if (valid)
             if (CanInvalidate())
-                callstackid = sALE->GetCallstackId();
+                callstackid = E->GetCallstackId();
             else
                 callstackid = 0;
         else
             callstackid = 1;
     }
+    // Marks the object as a read only view, views are invalidated at the end of the call stack
+    void SetView(uint32 position)
+    {
+        view = true;
+        viewPosition = position;
+        _invalidate = true;
+        SetValid(true);
+    }
+    // Replaces the viewed object with a copy owned by Lua
+    void SetOwnedCopy(void* copy)
+    {
+        view = false;
+        _invalidate = false;
+        SetObj(copy);
+    }
     // Sets whether the pointer will be invalidated at end of calls
     void SetValidation(bool invalidate)
     {
@@ -106,10 +173,15 @@ public:
     }
 
 private:
+    // The state the object was pushed to, its callstack decides the validity
+    ALE* E;
     uint64 callstackid;
     bool _invalidate;
+    bool view;
+    uint32 viewPosition;
     void* object;
     const char* type_name;
+    uint32 type_mask;
 };
 
 template<typename T>
@@ -126,6 +198,13 @@ public:
     static const char* tname;
     static bool manageMemory;
 
+    // Process wide id of the type, used to find its metatable in each state
+    static uint32 GetTypeId()
+    {
+        static const uint32 typeId = ALE::NewTypeId();
+        return typeId;
+    }
+
     // name will be used as type name
     // If gc is true, lua will handle the memory management for object pushed
     // gc should be used if pushing for example WorldPacket,
@@ -149,6 +228,14 @@ public:
         luaL_newmetatable(E->L, tname);
         int metatable  = lua_gettop(E->L);
 
+        // mark it as a metatable of ALE objects, see ALE::CHECKTYPE
+        lua_pushlightuserdata(E->L, ALEObject::GetMetatableMarker());
+        lua_rawseti(E->L, metatable, ALEObject::METATABLE_MARKER_KEY);
+
+        // keep an integer ref to it so pushing does not need a string lookup
+        lua_pushvalue(E->L, metatable);
+        E->SetMetatableRef(GetTypeId(), luaL_ref(E->L, LUA_REGISTRYINDEX));
+
         // push methodtable to stack to be accessed and modified by users
         lua_pushvalue(E->L, metatable);
         lua_setglobal(E->L, tname);
@@ -158,8 +245,13 @@ public:
         lua_setfield(E->L, metatable, "__tostring");
 
         // garbage collecting
-        lua_pushcfunction(E->L, CollectGarbage);
-        lua_setfield(E->L, metatable, "__gc");
+        // ALEObject lives inside the userdata and is trivially destructible,
+        // so only types owning the wrapped object need a finalizer
+        if (manageMemory)
+        {
+            lua_pushcfunction(E->L, CollectGarbage);
+            lua_setfield(E->L, metatable, "__gc");
+        }
 
         // make methods accessible through metatable
         lua_pushvalue(E->L, metatable);
@@ -237,8 +329,7 @@ public:
         ASSERT(methodTable);
 
         // get metatable
-        lua_pushstring(E->L, tname);
-        lua_rawget(E->L, LUA_REGISTRYINDEX);
+        lua_rawgeti(E->L, LUA_REGISTRYINDEX, E->GetMetatableRef(GetTypeId()));
         ASSERT(lua_istable(E->L, -1));
 
         for (; methodTable && methodTable->name && methodTable->mfunc; ++methodTable)
@@ -260,19 +351,38 @@ public:
             return 1;
         }
 
-        // Create new userdata
-        ALEObject** ptrHold = static_cast<ALEObject**>(lua_newuserdata(L, sizeof(ALEObject*)));
-        if (!ptrHold)
+        ALE* E = ALE::GetALE(L);
+
+        // Objects not owned by Lua are pushed once per call stack, repeated pushes
+        // return the same userdata so no garbage is created and rawequal works
+        if (!manageMemory)
+        {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, E->GetObjectCacheRef());
+            lua_pushlightuserdata(L, const_cast<T*>(obj));
+            lua_rawget(L, -2);
+            if (ALEObject* cached = static_cast<ALEObject*>(lua_touserdata(L, -1)))
+            {
+                if (cached->GetTypeName() == tname && cached->BelongsToCallstack(E->GetCallstackId()))
+                {
+                    lua_remove(L, -2);
+                    return 1;
+                }
+            }
+            lua_pop(L, 2);
+        }
+
+        // Create new userdata, the ALEObject is constructed in place inside it
+        void* userdata = lua_newuserdata(L, sizeof(ALEObject));
+        if (!userdata)
         {
             ALE_LOG_ERROR("{} could not create new userdata", tname);
             lua_pushnil(L);
             return 1;
         }
-        *ptrHold = new ALEObject(const_cast<T*>(obj), manageMemory);
+        new (userdata) ALEObject(E, const_cast<T*>(obj), manageMemory);
 
         // Set metatable for it
-        lua_pushstring(L, tname);
-        lua_rawget(L, LUA_REGISTRYINDEX);
+        lua_rawgeti(L, LUA_REGISTRYINDEX, E->GetMetatableRef(GetTypeId()));
         if (!lua_istable(L, -1))
         {
             ALE_LOG_ERROR("{} missing metatable", tname);
@@ -281,6 +391,26 @@ public:
             return 1;
         }
         lua_setmetatable(L, -2);
+
+        if (!manageMemory)
+        {
+            lua_rawgeti(L, LUA_REGISTRYINDEX, E->GetObjectCacheRef());
+            lua_pushlightuserdata(L, const_cast<T*>(obj));
+            lua_pushvalue(L, -3);
+            lua_rawset(L, -3);
+            lua_pop(L, 1);
+        }
+        return 1;
+    }
+
+    // Pushes obj without copying it, for types whose memory is managed by Lua.
+    // The view is invalidated at the end of the call stack, see PrepareCall for copying it on write.
+    // `position` is where the view's reads start
+    static int PushView(lua_State* L, T const* obj, uint32 position = 0)
+    {
+        Push(L, obj);
+        if (ALEObject* ALEObj = ALE::CHECKTYPE(L, -1, tname, false))
+            ALEObj->SetView(position);
         return 1;
     }
 
@@ -322,12 +452,18 @@ public:
         return 0;
     }
 
+    // Called before a method runs, remember special cases like ALETemplate<WorldPacket>::PrepareCall
+    static void PrepareCall(lua_State* /*L*/, ALERegister<T>* /*method*/)
+    {
+    }
+
     static int CallMethod(lua_State* L)
     {
+        ALERegister<T>* l = static_cast<ALERegister<T>*>(lua_touserdata(L, lua_upvalueindex(1)));
+        PrepareCall(L, l);
         T* obj = ALE::CHECKOBJ<T>(L, 1); // get self
         if (!obj)
             return 0;
-        ALERegister<T>* l = static_cast<ALERegister<T>*>(lua_touserdata(L, lua_upvalueindex(1)));
         int top = lua_gettop(L);
         int expected = l->mfunc(L, obj);
         int args = lua_gettop(L) - top;
@@ -347,9 +483,12 @@ public:
     {
         // Get object pointer (and check type, no error)
         ALEObject* obj = ALE::CHECKOBJ<ALEObject>(L, 1, false);
-        if (obj && manageMemory)
+        if (!obj)
+            return 0;
+        if (manageMemory && !obj->IsView())
             delete static_cast<T*>(obj->GetObj());
-        delete obj;
+        // The memory belongs to the userdata, only end the object's lifetime
+        obj->~ALEObject();
         return 0;
     }
 
@@ -378,7 +517,7 @@ public:
 };
 
 template<typename T>
-ALEObject::ALEObject(T * obj, bool manageMemory) : callstackid(1), _invalidate(!manageMemory), object(obj), type_name(ALETemplate<T>::tname)
+ALEObject::ALEObject(ALE* _E, T * obj, bool manageMemory) : E(_E), callstackid(1), _invalidate(!manageMemory), view(false), viewPosition(0), object(obj), type_name(ALETemplate<T>::tname), type_mask(ALETypeTraits<T>::mask)
 {
     SetValid(true);
 }
@@ -8,9 +8,14 @@
 #define _BINDING_MAP_H
 
 #include <memory>
+#include <atomic>
 #include "Common.h"
 #include "ALEUtility.h"
 #include <type_traits>
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include <cstring>
 
 extern "C"
 {
@@ -19,71 +24,942 @@ extern "C"
 };
 
 
+/*
+ * Passed to `PushRefsFor` to push the bindings of every update interval.
+ *
+ * Bindings of update hooks can have an interval in milliseconds, 0 means they are called on every update.
+ */
+constexpr uint32 BINDING_INTERVAL_ANY = std::numeric_limits<uint32>::max();
+
+/*
+ * Returns a new binding map generation, see `BindingMap::GetGeneration`.
+ *
+ * Values come from a process wide counter so that a recreated BindingMap never repeats one, 0 is never returned.
+ */
+inline uint64 NextBindingGeneration()
+{
+    static std::atomic<uint64> counter(0);
+    return ++counter;
+}
+
+/*
+ * Per object timers of the update hook bindings that have an interval.
+ *
+ * Kept by whatever the hook updates (creature AI, instance AI, ...) so that
+ *   handlers are only called once their interval has passed for that object.
+ */
+class ALEUpdateTimers
+{
+public:
+    ALEUpdateTimers() : time(0), intervalGenerations{ 0, 0 } { }
+
+    void Update(uint32 diff) { time += diff; }
+
+    /*
+     * Returns true if `interval` has passed since the handlers with that interval were last called
+     *   and sets `elapsed` to the time since then. The first check of an interval starts its timer.
+     */
+    bool IsDue(uint32 interval, uint32& elapsed)
+    {
+        for (IntervalTimer& timer : timers)
+        {
+            if (timer.interval != interval)
+                continue;
+
+            elapsed = time - timer.lastCall;
+            if (elapsed < interval)
+                return false;
+
+            timer.lastCall = time;
+            return true;
+        }
+
+        timers.push_back({ interval, time, false });
+        return false;
+    }
+
+    /*
+     * Returns what the handlers with `interval` returned when they were last called, false until then.
+     *
+     * Lets hooks whose handlers can suppress a default action keep it suppressed until they run again.
+     */
+    bool GetLastResult(uint32 interval) const
+    {
+        for (const IntervalTimer& timer : timers)
+            if (timer.interval == interval)
+                return timer.lastResult;
+        return false;
+    }
+
+    /*
+     * Stores the result of the handlers with `interval`, called after `IsDue` returned true for it.
+     */
+    void SetLastResult(uint32 interval, bool result)
+    {
+        for (IntervalTimer& timer : timers)
+        {
+            if (timer.interval == interval)
+            {
+                timer.lastResult = result;
+                return;
+            }
+        }
+    }
+
+    /*
+     * Returns true if the cached intervals were looked up at the given generations of the binding maps.
+     */
+    bool HasIntervalsFor(uint64 generation1, uint64 generation2) const
+    {
+        return generation1 == intervalGenerations[0] && generation2 == intervalGenerations[1];
+    }
+
+    /*
+     * Empties the cached intervals for a new lookup at the given generations and returns them to be filled.
+     */
+    std::vector<uint32>& ResetIntervals(uint64 generation1, uint64 generation2)
+    {
+        intervalGenerations[0] = generation1;
+        intervalGenerations[1] = generation2;
+        intervals.clear();
+        return intervals;
+    }
+
+    const std::vector<uint32>& GetIntervals() const { return intervals; }
+
+private:
+    struct IntervalTimer
+    {
+        uint32 interval;
+        // Time the handlers with the interval were last called
+        uint32 lastCall;
+        bool lastResult;
+    };
+
+    uint32 time;
+    std::vector<IntervalTimer> timers;
+    // Update intervals of the object's bindings, valid while the binding maps have these generations
+    std::vector<uint32> intervals;
+    uint64 intervalGenerations[2];
+};
+
+/*
+ * Tracks which event IDs have bindings so that hooks can be skipped without locking.
+ *
+ * Written under the owning BindingMap's lock, read without it so that hooks
+ *   nobody listens to cost a single relaxed load instead of a lock and a lookup.
+ */
+class BindingPresence
+{
+public:
+    /*
+     * Event IDs below this have their presence tracked in `presence`.
+     * All hook enums are smaller than this, larger IDs always take the locked path.
+     */
+    static constexpr uint32 PRESENCE_BITS = 128;
+
+    BindingPresence()
+    {
+        ClearPresence();
+    }
+
+    /*
+     * Check whether any key with `event_id` has bindings, without locking.
+     */
+    bool HasBindingsForEvent(uint32 event_id) const
+    {
+        if (event_id >= PRESENCE_BITS)
+            return true;
+
+        return (presence[event_id / 64].load(std::memory_order_relaxed) & (uint64(1) << (event_id % 64))) != 0;
+    }
+
+protected:
+    void AddPresence(uint32 event_id, uint32 count)
+    {
+        if (event_id >= PRESENCE_BITS || !count)
+            return;
+
+        if (!eventBindingCounts[event_id])
+            presence[event_id / 64].fetch_or(uint64(1) << (event_id % 64), std::memory_order_relaxed);
+        eventBindingCounts[event_id] += count;
+    }
+
+    void RemovePresence(uint32 event_id, uint32 count)
+    {
+        if (event_id >= PRESENCE_BITS || !count)
+            return;
+
+        ASSERT(eventBindingCounts[event_id] >= count);
+        eventBindingCounts[event_id] -= count;
+        if (!eventBindingCounts[event_id])
+            presence[event_id / 64].fetch_and(~(uint64(1) << (event_id % 64)), std::memory_order_relaxed);
+    }
+
+    void ClearPresence()
+    {
+        for (auto& word : presence)
+            word.store(0, std::memory_order_relaxed);
+        for (uint32& count : eventBindingCounts)
+            count = 0;
+    }
+
+private:
+    // One bit per event ID, set while any key with that event ID has bindings
+    std::atomic<uint64> presence[PRESENCE_BITS / 64];
+    // Amount of bindings per event ID
+    uint32 eventBindingCounts[PRESENCE_BITS];
+};
+
+/*
+ * Event properties a binding can be filtered on, see `BindingFilter`.
+ */
+enum BindingFilterField
+{
+    FILTER_MAP_ID,
+    FILTER_ZONE_ID,
+    FILTER_CLASS,
+    FILTER_SPELL_ID,
+    FILTER_ENTRY,
+    FILTER_CHAT_TYPE,
+    FILTER_FIELD_COUNT
+};
+
+/*
+ * The properties of an event that binding filters are checked against, set by hooks that support filters.
+ */
+class BindingFilterContext
+{
+public:
+    BindingFilterContext() : fields(0) { }
+
+    void Set(BindingFilterField field, uint32 value)
+    {
+        values[field] = value;
+        fields |= 1 << field;
+    }
+
+    bool Get(BindingFilterField field, uint32& value) const
+    {
+        if (!(fields & (1 << field)))
+            return false;
+
+        value = values[field];
+        return true;
+    }
+
+private:
+    uint32 values[FILTER_FIELD_COUNT];
+    // Mask of the fields that were set
+    uint32 fields;
+};
+
+/*
+ * Conditions an event has to meet for a binding to be called, checked before entering Lua.
+ *
+ * Each field with values matches if the event's property is one of them, all fields have to match.
+ */
+class BindingFilter
+{
+public:
+    BindingFilter() : fields(0) { }
+
+    void Add(BindingFilterField field, uint32 value)
+    {
+        std::vector<uint32>& list = values[field];
+        auto i = std::lower_bound(list.begin(), list.end(), value);
+        if (i == list.end() || *i != value)
+            list.insert(i, value);
+        fields |= 1 << field;
+    }
+
+    // Mask of the fields the filter has values for
+    uint32 GetFields() const { return fields; }
+
+    bool Matches(const BindingFilterContext& context) const
+    {
+        for (uint32 field = 0; field < FILTER_FIELD_COUNT; ++field)
+        {
+            if (!(fields & (1 << field)))
+                continue;
+
+            uint32 value;
+            if (!context.Get(BindingFilterField(field), value))
+                return false;
+
+            if (!std::binary_search(values[field].begin(), values[field].end(), value))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    // Sorted values per field
+    std::vector<uint32> values[FILTER_FIELD_COUNT];
+    uint32 fields;
+};
+
+/*
+ * Sets `field` to the filter field with the given name in Lua filter tables, returns false if there is none.
+ */
+inline bool GetBindingFilterField(const char* name, BindingFilterField& field)
+{
+    static const struct
+    {
+        const char* name;
+        BindingFilterField field;
+    } fields[] =
+    {
+        { "map", FILTER_MAP_ID },
+        { "zone", FILTER_ZONE_ID },
+        { "class", FILTER_CLASS },
+        { "spell", FILTER_SPELL_ID },
+        { "entry", FILTER_ENTRY },
+        { "chatType", FILTER_CHAT_TYPE }
+    };
+
+    for (const auto& f : fields)
+    {
+        if (strcmp(f.name, name) == 0)
+        {
+            field = f.field;
+            return true;
+        }
+    }
+    return false;
+}
+
+/*
+ * A binding to a Lua function reference, stored inline in its key's binding list snapshots.
+ *
+ * Everything but the remaining shots is immutable. Shot-limited bindings are spent once their
+ *   shots reach 0 and are skipped from then on, until the owning BindingMap compacts them away.
+ *   The shots are counted once per binding, a copy of the list made while replacing a snapshot
+ *   shares them with the snapshot it was copied from.
+ *
+ * The function reference is released by the BindingMap when it removes the binding,
+ *   not when the last snapshot holding it goes away.
+ */
+struct SharedBinding
+{
+    uint64 id;
+    uint32 interval;
+    int functionReference;
+    // Null for bindings without a shot limit, see `TakeShot`
+    std::shared_ptr<std::atomic<uint32>> remainingShots;
+    // Optional, see `Accepts`
+    std::shared_ptr<const BindingFilter> filter;
+
+    SharedBinding(uint64 id, int functionReference, uint32 shots, uint32 interval, std::shared_ptr<const BindingFilter> filter = nullptr) :
+        id(id),
+        interval(interval),
+        functionReference(functionReference),
+        remainingShots(shots > 0 ? std::make_shared<std::atomic<uint32>>(shots) : nullptr),
+        filter(std::move(filter))
+    { }
+
+    /*
+     * Check whether the binding should be called for the event with the properties in `context`.
+     *
+     * Filtered bindings are only called by hooks that give a context.
+     */
+    bool Accepts(const BindingFilterContext* context) const
+    {
+        return !filter || (context && filter->Matches(*context));
+    }
+
+    /*
+     * Uses up one shot, returns false if the binding is already spent.
+     */
+    bool TakeShot() const
+    {
+        if (!remainingShots)
+            return true;
+
+        uint32 shots = remainingShots->load(std::memory_order_relaxed);
+        do
+        {
+            if (!shots)
+                return false;
+        } while (!remainingShots->compare_exchange_weak(shots, shots - 1, std::memory_order_relaxed));
+        return true;
+    }
+
+    bool IsSpent() const
+    {
+        return remainingShots && !remainingShots->load(std::memory_order_relaxed);
+    }
+};
+
+/*
+ * Inclusive entry ranges of a binding to many entries, sorted and without overlaps
+ *   once passed through `NormalizeEntryRanges`.
+ */
+typedef std::vector< std::pair<uint32, uint32> > EntryRangeList;
+
+/*
+ * Sort `ranges` and merge the overlapping and adjacent ones.
+ */
+inline void NormalizeEntryRanges(EntryRangeList& ranges)
+{
+    std::sort(ranges.begin(), ranges.end());
+
+    size_t count = 0;
+    for (const std::pair<uint32, uint32>& range : ranges)
+    {
+        if (count && uint64(range.first) <= uint64(ranges[count - 1].second) + 1)
+            ranges[count - 1].second = std::max(ranges[count - 1].second, range.second);
+        else
+            ranges[count++] = range;
+    }
+    ranges.resize(count);
+}
+
+inline bool EntryRangesContain(const EntryRangeList& ranges, uint32 entry)
+{
+    // First range starting after `entry`, the one before it is the only one that can contain it
+    auto next = std::upper_bound(ranges.begin(), ranges.end(), entry,
+        [](uint32 value, const std::pair<uint32, uint32>& range) { return value < range.first; });
+    return next != ranges.begin() && entry <= (next - 1)->second;
+}
+
+/*
+ * Returns `ranges` without `entry`.
+ */
+inline EntryRangeList EntryRangesWithout(const EntryRangeList& ranges, uint32 entry)
+{
+    EntryRangeList result;
+    for (const std::pair<uint32, uint32>& range : ranges)
+    {
+        if (entry < range.first || entry > range.second)
+        {
+            result.push_back(range);
+            continue;
+        }
+
+        if (entry > range.first)
+            result.emplace_back(range.first, entry - 1);
+        if (entry < range.second)
+            result.emplace_back(entry + 1, range.second);
+    }
+    return result;
+}
+
+typedef std::vector<SharedBinding> SharedBindingList;
+/*
+ * An immutable binding list. Changing a key's bindings replaces its snapshot instead of
+ *   modifying it, so a snapshot can be read without the BindingMap's lock.
+ */
+typedef std::shared_ptr<const SharedBindingList> SharedBindingSnapshot;
+
+/*
+ * Returns `list` to append a binding to, copied first if a reader still holds it as a snapshot.
+ *
+ * Snapshots are only taken under the BindingMap's lock, so while the caller holds the lock a list
+ *   without other owners can't be read and is appended to in place. Registering many bindings
+ *   to one key then costs an amortized push_back per binding instead of a copy of the list.
+ */
+inline SharedBindingList& AppendableBindingList(std::shared_ptr<SharedBindingList>& list)
+{
+    if (!list)
+        list = std::make_shared<SharedBindingList>();
+    else if (list.use_count() > 1)
+        list = std::make_shared<SharedBindingList>(*list);
+    else
+        // Pairs with the release of the last reader's reference, its reads happen before the append
+        std::atomic_thread_fence(std::memory_order_acquire);
+    return *list;
+}
+
+/*
+ * Push the references of the bindings in `list` with the given update interval (or all of them)
+ *   that accept the event described by `context` onto the stack.
+ *
+ * Returns true if a binding used up its last shot and the list should be compacted.
+ */
+inline bool PushSharedBindingRefs(lua_State* L, const SharedBindingList& list, uint32 interval, const BindingFilterContext* context)
+{
+    bool spent = false;
+    for (const SharedBinding& binding : list)
+    {
+        if (interval != BINDING_INTERVAL_ANY && binding.interval != interval)
+            continue;
+
+        if (!binding.Accepts(context))
+            continue;
+
+        if (!binding.TakeShot())
+            continue;
+
+        lua_rawgeti(L, LUA_REGISTRYINDEX, binding.functionReference);
+        if (binding.IsSpent())
+            spent = true;
+    }
+    return spent;
+}
+
 /*
  * A set of bindings from keys of type `K` to Lua references.
+ *
+ * Each key maps to a binding list snapshot (see `SharedBindingSnapshot`). The lock is only held
+ *   to look up or replace a snapshot, pushing the references happens without it.
+ *   Inserting appends in place unless the snapshot is being read, see `AppendableBindingList`.
+ *
+ * Keys with an entry (see `KeyEntry`) can also be bound to many entries at once with `InsertRanges`.
  */
 template<typename K>
-class BindingMap : public ALEUtil::Lockable
+class BindingMap : public ALEUtil::Lockable, public BindingPresence
 {
 private:
     lua_State* L;
     uint64 maxBindingID;
 
-    struct Binding
+    std::unordered_map<K, std::shared_ptr<SharedBindingList>> bindings;
+
+    /*
+     * A binding of one function to the entries in `ranges`, see `InsertRanges`.
+     */
+    struct RangedBinding
     {
-        uint64 id;
-        lua_State* L;
-        uint32 remainingShots;
-        int functionReference;
+        SharedBinding binding;
+        // The bound key, its entry is not used
+        K key;
+        EntryRangeList ranges;
 
-        Binding(lua_State* L, uint64 id, int functionReference, uint32 remainingShots) :
-            id(id),
-            L(L),
-            remainingShots(remainingShots),
-            functionReference(functionReference)
+        RangedBinding(const SharedBinding& binding, const K& key, EntryRangeList ranges) :
+            binding(binding),
+            key(key),
+            ranges(std::move(ranges))
         { }
+    };
+
+    typedef std::vector< std::shared_ptr<const RangedBinding> > RangedBindingList;
+    typedef std::shared_ptr<const RangedBindingList> RangedBindingSnapshot;
+
+    /*
+     * Ranged bindings indexed by event ID, kept apart from the per key lists so that a function
+     *   bound to thousands of entries takes one binding and a few ranges instead of a binding and
+     *   a hash bucket per entry. Snapshots are replaced like the per key ones.
+     */
+    std::vector<RangedBindingSnapshot> rangedBindings;
+    // Event ID of each ranged binding, for `Remove`
+    std::unordered_map<uint64, uint32> rangedBindingEvents;
+
+    RangedBindingSnapshot GetRangedSnapshot(uint32 event_id) const
+    {
+        return event_id < rangedBindings.size() ? rangedBindings[event_id] : nullptr;
+    }
+
+    bool RangedBindingsContain(const K& key) const
+    {
+        uint32 entry;
+        if (!KeyEntry(key, entry))
+            return false;
 
-        ~Binding()
+        RangedBindingSnapshot ranged = GetRangedSnapshot(static_cast<uint32>(key.event_id));
+        if (!ranged)
+            return false;
+
+        for (const std::shared_ptr<const RangedBinding>& rangedBinding : *ranged)
+            if (EntryRangesContain(rangedBinding->ranges, entry))
+                return true;
+        return false;
+    }
+
+    void PublishRanged(uint32 event_id, std::shared_ptr<RangedBindingList> list)
+    {
+        if (list->empty())
+            rangedBindings[event_id].reset();
+        else
+            rangedBindings[event_id] = std::move(list);
+        BumpGeneration();
+    }
+
+    /*
+     * Update the key presence bits of the entries in `ranges` after a ranged binding of `key`'s event was removed.
+     */
+    void RefreshKeyPresence(const K& key, const EntryRangeList& ranges)
+    {
+        if (!keyPresence)
+            return;
+
+        K entryKey = key;
+        for (const std::pair<uint32, uint32>& range : ranges)
         {
-            luaL_unref(L, LUA_REGISTRYINDEX, functionReference);
+            for (uint32 entry = range.first; entry <= range.second && entry < keyPresenceEntries; ++entry)
+            {
+                SetKeyEntry(entryKey, entry);
+                SetKeyPresence(entryKey, bindings.find(entryKey) != bindings.end() || RangedBindingsContain(entryKey));
+            }
         }
-    };
+    }
+
+    /*
+     * Remove the spent ranged bindings of `event_id`, see `CompactSpent`.
+     */
+    void CompactSpentRanged(uint32 event_id)
+    {
+        Guard guard(GetLock());
 
-    typedef std::vector< std::unique_ptr<Binding> > BindingList;
+        RangedBindingSnapshot ranged = GetRangedSnapshot(event_id);
+        if (!ranged)
+            return;
 
-    std::unordered_map<K, BindingList> bindings;
+        std::shared_ptr<RangedBindingList> list = std::make_shared<RangedBindingList>();
+        std::vector< std::shared_ptr<const RangedBinding> > spent;
+        for (const std::shared_ptr<const RangedBinding>& rangedBinding : *ranged)
+        {
+            if (rangedBinding->binding.IsSpent())
+                spent.push_back(rangedBinding);
+            else
+                list->push_back(rangedBinding);
+        }
+
+        // Another push already compacted the list
+        if (spent.empty())
+            return;
+
+        PublishRanged(event_id, list);
+        for (const std::shared_ptr<const RangedBinding>& rangedBinding : spent)
+        {
+            Unref(rangedBinding->binding);
+            rangedBindingEvents.erase(rangedBinding->binding.id);
+            RemovePresence(event_id, 1);
+            RefreshKeyPresence(rangedBinding->key, rangedBinding->ranges);
+        }
+    }
+
+    /*
+     * Remove `key`'s entry from the ranged bindings of its event, see `Clear(const K& key)`.
+     */
+    void ClearRanged(const K& key)
+    {
+        uint32 entry;
+        if (!KeyEntry(key, entry))
+            return;
+
+        uint32 event_id = static_cast<uint32>(key.event_id);
+        RangedBindingSnapshot ranged = GetRangedSnapshot(event_id);
+        if (!ranged)
+            return;
+
+        std::shared_ptr<RangedBindingList> list = std::make_shared<RangedBindingList>();
+        bool changed = false;
+        for (const std::shared_ptr<const RangedBinding>& rangedBinding : *ranged)
+        {
+            if (!EntryRangesContain(rangedBinding->ranges, entry))
+            {
+                list->push_back(rangedBinding);
+                continue;
+            }
+
+            changed = true;
+            EntryRangeList ranges = EntryRangesWithout(rangedBinding->ranges, entry);
+            if (!ranges.empty())
+            {
+                list->push_back(std::make_shared<const RangedBinding>(rangedBinding->binding, rangedBinding->key, std::move(ranges)));
+                continue;
+            }
+
+            Unref(rangedBinding->binding);
+            rangedBindingEvents.erase(rangedBinding->binding.id);
+            RemovePresence(event_id, 1);
+        }
+
+        if (!changed)
+            return;
+
+        PublishRanged(event_id, list);
+        SetKeyPresence(key, bindings.find(key) != bindings.end());
+    }
+
+    /*
+     * Remove the ranged binding `id` of `event_id`, see `Remove`.
+     */
+    void RemoveRanged(uint64 id, uint32 event_id)
+    {
+        RangedBindingSnapshot ranged = GetRangedSnapshot(event_id);
+        if (!ranged)
+            return;
+
+        std::shared_ptr<RangedBindingList> list = std::make_shared<RangedBindingList>();
+        std::shared_ptr<const RangedBinding> removed;
+        for (const std::shared_ptr<const RangedBinding>& rangedBinding : *ranged)
+        {
+            if (rangedBinding->binding.id == id)
+                removed = rangedBinding;
+            else
+                list->push_back(rangedBinding);
+        }
+
+        if (!removed)
+            return;
+
+        Unref(removed->binding);
+        RemovePresence(event_id, 1);
+        PublishRanged(event_id, list);
+        RefreshKeyPresence(removed->key, removed->ranges);
+    }
     /*
      * This table is for fast removal of bindings by ID.
      *
-     * Instead of having to look through (potentially) every BindingList to find
-     *   the Binding with the right ID, this allows you to go directly to the
-     *   BindingList that might have the Binding with that ID.
+     * Instead of having to look through (potentially) every binding list to find
+     *   the binding with the right ID, this allows you to go directly to the
+     *   key whose binding list might have the binding with that ID.
+     */
+    std::unordered_map<uint64, K> id_lookup_table;
+
+    void Unref(const SharedBinding& binding)
+    {
+        luaL_unref(L, LUA_REGISTRYINDEX, binding.functionReference);
+    }
+
+    void UnrefAll()
+    {
+        for (auto& pair : bindings)
+            for (const SharedBinding& binding : *pair.second)
+                Unref(binding);
+
+        for (RangedBindingSnapshot& ranged : rangedBindings)
+            if (ranged)
+                for (const std::shared_ptr<const RangedBinding>& rangedBinding : *ranged)
+                    Unref(rangedBinding->binding);
+    }
+
+    /*
+     * Replace the snapshot of `key` with `list`, the key is erased once it has no bindings left.
+     */
+    void Publish(const K& key, std::shared_ptr<SharedBindingList> list)
+    {
+        if (list->empty())
+        {
+            bindings.erase(key);
+            SetKeyPresence(key, RangedBindingsContain(key));
+        }
+        else
+        {
+            bindings[key] = std::move(list);
+            SetKeyPresence(key, true);
+        }
+        BumpGeneration();
+    }
+
+    /*
+     * Get the snapshots of `key`'s bindings and of its event's ranged bindings, returns false if there are neither.
+     */
+    bool GetSnapshots(const K& key, SharedBindingSnapshot& snapshot, RangedBindingSnapshot& ranged)
+    {
+        Guard guard(GetLock());
+
+        auto result = bindings.find(key);
+        if (result != bindings.end())
+            snapshot = result->second;
+
+        uint32 entry;
+        if (KeyEntry(key, entry))
+            ranged = GetRangedSnapshot(static_cast<uint32>(key.event_id));
+
+        return snapshot || ranged;
+    }
+
+    /*
+     * Remove the spent bindings of `key`, called after pushing its references used up a binding's last shot.
+     */
+    void CompactSpent(const K& key)
+    {
+        Guard guard(GetLock());
+
+        auto iter = bindings.find(key);
+        if (iter == bindings.end())
+            return;
+
+        std::shared_ptr<SharedBindingList> list = std::make_shared<SharedBindingList>();
+        uint32 spent = 0;
+        for (const SharedBinding& binding : *iter->second)
+        {
+            if (!binding.IsSpent())
+            {
+                list->push_back(binding);
+                continue;
+            }
+
+            Unref(binding);
+            id_lookup_table.erase(binding.id);
+            ++spent;
+        }
+
+        // Another push already compacted the list
+        if (!spent)
+            return;
+
+        RemovePresence(key.event_id, spent);
+        RemoveObjectBindings(key, spent);
+        Publish(key, list);
+    }
+
+    /*
+     * Optional presence bit per key, set while the key has bindings.
+     *
+     * Only keys with a small index (see `KeyPresenceIndex`) are tracked, which lets
+     *   e.g. packet hooks skip the lock for opcodes nobody listens to.
+     */
+    std::unique_ptr<std::atomic<uint64>[]> keyPresence;
+    uint32 keyPresenceEvents;
+    uint32 keyPresenceEntries;
+
+    bool GetKeyPresenceIndex(const K& key, uint32& index) const
+    {
+        return keyPresence && KeyPresenceIndex(key, keyPresenceEvents, keyPresenceEntries, index);
+    }
+
+    void SetKeyPresence(const K& key, bool present)
+    {
+        uint32 index;
+        if (!GetKeyPresenceIndex(key, index))
+            return;
+
+        uint64 bit = uint64(1) << (index % 64);
+        if (present)
+            keyPresence[index / 64].fetch_or(bit, std::memory_order_relaxed);
+        else
+            keyPresence[index / 64].fetch_and(~bit, std::memory_order_relaxed);
+    }
+
+    void ClearKeyPresence()
+    {
+        if (!keyPresence)
+            return;
+
+        uint32 words = (keyPresenceEvents * keyPresenceEntries + 63) / 64;
+        for (uint32 i = 0; i < words; ++i)
+            keyPresence[i].store(0, std::memory_order_relaxed);
+    }
+
+    /*
+     * Amount of bindings per object (entry, unique object, ...) over all its events.
      *
-     * However, you must be careful not to store pointers to BindingLists
-     *   that no longer exist (see `void Clear(const K& key)` implementation).
+     * Keyed by the object's key with the event ID cleared, see `HasBindingsForObject`.
      */
-    std::unordered_map<uint64, BindingList*> id_lookup_table;
+    std::unordered_map<K, uint32> objectBindingCounts;
+
+    static K ObjectKeyOf(const K& key)
+    {
+        K objectKey = key;
+        objectKey.event_id = static_cast<decltype(key.event_id)>(0);
+        return objectKey;
+    }
+
+    void AddObjectBindings(const K& key, uint32 count)
+    {
+        objectBindingCounts[ObjectKeyOf(key)] += count;
+    }
+
+    // Changes whenever a binding is added or removed, see `GetGeneration`
+    std::atomic<uint64> generation;
+
+    void BumpGeneration()
+    {
+        generation.store(NextBindingGeneration(), std::memory_order_release);
+    }
+
+    void RemoveObjectBindings(const K& key, uint32 count)
+    {
+        auto iter = objectBindingCounts.find(ObjectKeyOf(key));
+        if (iter == objectBindingCounts.end())
+            return;
+
+        ASSERT(iter->second >= count);
+        iter->second -= count;
+        if (!iter->second)
+            objectBindingCounts.erase(iter);
+    }
 
 public:
-    BindingMap(lua_State* L) :
+    /*
+     * If `presenceEvents` and `presenceEntries` are given, keys with an event ID and entry
+     *   below them get their presence tracked so `HasBindingsFor` does not need to lock.
+     */
+    BindingMap(lua_State* L, uint32 presenceEvents = 0, uint32 presenceEntries = 0) :
         L(L),
-        maxBindingID(0)
-    { }
+        maxBindingID(0),
+        keyPresenceEvents(presenceEvents),
+        keyPresenceEntries(presenceEntries),
+        generation(NextBindingGeneration())
+    {
+        if (presenceEvents && presenceEntries)
+        {
+            keyPresence.reset(new std::atomic<uint64>[(presenceEvents * presenceEntries + 63) / 64]);
+            ClearKeyPresence();
+        }
+    }
+
+    ~BindingMap()
+    {
+        UnrefAll();
+    }
 
     /*
      * Insert a new binding from `key` to `ref`, which lasts for `shots`-many pushes.
      *
      * If `shots` is 0, it will never automatically expire, but can still be
      *   removed with `Clear` or `Remove`.
+     *
+     * `interval` is the update interval of bindings to update hooks, see `GetIntervalsFor`.
+     */
+    uint64 Insert(const K& key, int ref, uint32 shots, uint32 interval = 0)
+    {
+        Guard guard(GetLock());
+
+        uint64 id = (++maxBindingID);
+        AppendableBindingList(bindings[key]).emplace_back(id, ref, shots, interval);
+
+        id_lookup_table.emplace(id, key);
+        AddPresence(key.event_id, 1);
+        AddObjectBindings(key, 1);
+        SetKeyPresence(key, true);
+        BumpGeneration();
+        return id;
+    }
+
+    /*
+     * Insert a new binding from the keys with `key`'s event ID and an entry in `ranges` to `ref`,
+     *   the entry of `key` is not used. Only for keys with an entry, see `KeyEntry`.
+     *
+     * The binding is shared by all the entries: it takes a single reference and `shots` counts
+     *   the pushes for any of them. `Clear` for one of the entries only removes that entry from it.
      */
-    uint64 Insert(const K& key, int ref, uint32 shots)
+    uint64 InsertRanges(const K& key, EntryRangeList ranges, int ref, uint32 shots, uint32 interval = 0)
     {
+        NormalizeEntryRanges(ranges);
+
         Guard guard(GetLock());
 
+        uint32 event_id = static_cast<uint32>(key.event_id);
+        if (rangedBindings.size() <= event_id)
+            rangedBindings.resize(event_id + 1);
+
         uint64 id = (++maxBindingID);
-        BindingList& list = bindings[key];
-        list.push_back(std::unique_ptr<Binding>(new Binding(L, id, ref, shots)));
-        id_lookup_table[id] = &list;
+        std::shared_ptr<RangedBindingList> list = std::make_shared<RangedBindingList>();
+        if (rangedBindings[event_id])
+            *list = *rangedBindings[event_id];
+        list->push_back(std::make_shared<const RangedBinding>(SharedBinding(id, ref, shots, interval), key, ranges));
+
+        rangedBindingEvents.emplace(id, event_id);
+        AddPresence(event_id, 1);
+        PublishRanged(event_id, list);
+
+        if (keyPresence)
+        {
+            K entryKey = key;
+            for (const std::pair<uint32, uint32>& range : ranges)
+            {
+                for (uint32 entry = range.first; entry <= range.second && entry < keyPresenceEntries; ++entry)
+                {
+                    SetKeyEntry(entryKey, entry);
+                    SetKeyPresence(entryKey, true);
+                }
+            }
+        }
         return id;
     }
 
@@ -94,6 +970,8 @@ public:
     {
         Guard guard(GetLock());
 
+        ClearRanged(key);
+
         if (bindings.empty())
             return;
 
@@ -101,16 +979,16 @@ public:
         if (iter == bindings.end())
             return;
 
-        BindingList& list = iter->second;
-
-        // Remove all pointers to `list` from `id_lookup_table`.
-        for (auto i = list.begin(); i != list.end(); ++i)
+        const SharedBindingList& list = *iter->second;
+        for (const SharedBinding& binding : list)
         {
-            std::unique_ptr<Binding>& binding = *i;
-            id_lookup_table.erase(binding->id);
+            Unref(binding);
+            id_lookup_table.erase(binding.id);
         }
 
-        bindings.erase(key);
+        RemovePresence(key.event_id, list.size());
+        RemoveObjectBindings(key, list.size());
+        Publish(key, std::make_shared<SharedBindingList>());
     }
 
     /*
@@ -120,11 +998,19 @@ public:
     {
         Guard guard(GetLock());
 
-        if (bindings.empty())
+        if (bindings.empty() && rangedBindingEvents.empty())
             return;
 
+        UnrefAll();
+
         id_lookup_table.clear();
         bindings.clear();
+        rangedBindingEvents.clear();
+        rangedBindings.clear();
+        objectBindingCounts.clear();
+        ClearPresence();
+        ClearKeyPresence();
+        BumpGeneration();
     }
 
     /*
@@ -138,24 +1024,44 @@ public:
 
         auto iter = id_lookup_table.find(id);
         if (iter == id_lookup_table.end())
+        {
+            auto ranged = rangedBindingEvents.find(id);
+            if (ranged != rangedBindingEvents.end())
+            {
+                uint32 event_id = ranged->second;
+                rangedBindingEvents.erase(ranged);
+                RemoveRanged(id, event_id);
+            }
             return;
+        }
 
-        BindingList* list = iter->second;
-        auto i = list->begin();
+        K key = iter->second;
+        id_lookup_table.erase(iter);
+
+        auto result = bindings.find(key);
+        if (result == bindings.end())
+            return;
 
-        for (; i != list->end(); ++i)
+        std::shared_ptr<SharedBindingList> list = std::make_shared<SharedBindingList>();
+        bool removed = false;
+        for (const SharedBinding& binding : *result->second)
         {
-            std::unique_ptr<Binding>& binding = *i;
-            if (binding->id == id)
-                break;
+            if (binding.id != id)
+            {
+                list->push_back(binding);
+                continue;
+            }
+
+            Unref(binding);
+            removed = true;
         }
 
-        if (i != list->end())
-            list->erase(i);
+        if (!removed)
+            return;
 
-        // Unconditionally erase the ID in the lookup table because
-        //   it was either already invalid, or it's no longer valid.
-        id_lookup_table.erase(id);
+        RemovePresence(key.event_id, 1);
+        RemoveObjectBindings(key, 1);
+        Publish(key, list);
     }
 
     /*
@@ -163,52 +1069,144 @@ public:
      */
     bool HasBindingsFor(const K& key)
     {
+        // Most hooks have no bindings at all, skip the lock and lookup for them
+        if (!HasBindingsForEvent(key.event_id))
+            return false;
+
+        uint32 index;
+        if (GetKeyPresenceIndex(key, index))
+            return (keyPresence[index / 64].load(std::memory_order_relaxed) & (uint64(1) << (index % 64))) != 0;
+
         Guard guard(GetLock());
 
-        if (bindings.empty())
-            return false;
+        // Keys are erased when their last binding is removed
+        return bindings.find(key) != bindings.end() || RangedBindingsContain(key);
+    }
 
-        auto result = bindings.find(key);
-        if (result == bindings.end())
-            return false;
+    /*
+     * Check whether the object of `key` has bindings for any event, the event ID of `key` is ignored.
+     *
+     * Lets e.g. AI selection check all creature events of an entry with a single lookup.
+     */
+    bool HasBindingsForObject(const K& key)
+    {
+        Guard guard(GetLock());
 
-        BindingList& list = result->second;
-        return !list.empty();
+        if (objectBindingCounts.find(ObjectKeyOf(key)) != objectBindingCounts.end())
+            return true;
+
+        K eventKey = key;
+        for (uint32 event_id = 0; event_id < rangedBindings.size(); ++event_id)
+        {
+            eventKey.event_id = static_cast<decltype(key.event_id)>(event_id);
+            if (RangedBindingsContain(eventKey))
+                return true;
+        }
+        return false;
     }
 
     /*
-     * Push all Lua references for `key` onto the stack.
+     * Returns a value that changes whenever bindings are added or removed.
+     *
+     * Lets callers cache what they looked up (see `GetEventMaskForObject`) and
+     *   only look it up again once the generation differs from the cached one.
+     */
+    uint64 GetGeneration() const
+    {
+        return generation.load(std::memory_order_acquire);
+    }
+
+    /*
+     * Returns a mask of the event IDs below `eventCount` (at most 64) the object of `key` has bindings for,
+     *   the event ID of `key` is ignored.
      */
-    void PushRefsFor(const K& key)
+    uint64 GetEventMaskForObject(const K& key, uint32 eventCount)
     {
+        ASSERT(eventCount <= 64);
+
         Guard guard(GetLock());
 
-        if (bindings.empty())
+        uint64 mask = 0;
+        bool hasKeys = objectBindingCounts.find(ObjectKeyOf(key)) != objectBindingCounts.end();
+        if (!hasKeys && rangedBindings.empty())
+            return mask;
+
+        K eventKey = key;
+        for (uint32 event_id = 0; event_id < eventCount; ++event_id)
+        {
+            eventKey.event_id = static_cast<decltype(key.event_id)>(event_id);
+            if ((hasKeys && bindings.find(eventKey) != bindings.end()) || RangedBindingsContain(eventKey))
+                mask |= uint64(1) << event_id;
+        }
+        return mask;
+    }
+
+    /*
+     * Append the update intervals of the bindings for `key` to `intervals`, skipping the ones already in it.
+     */
+    void GetIntervalsFor(const K& key, std::vector<uint32>& intervals)
+    {
+        SharedBindingSnapshot snapshot;
+        RangedBindingSnapshot ranged;
+        if (!GetSnapshots(key, snapshot, ranged))
             return;
 
-        auto result = bindings.find(key);
-        if (result == bindings.end())
+        if (snapshot)
+            for (const SharedBinding& binding : *snapshot)
+                if (std::find(intervals.begin(), intervals.end(), binding.interval) == intervals.end())
+                    intervals.push_back(binding.interval);
+
+        uint32 entry;
+        if (ranged && KeyEntry(key, entry))
+            for (const std::shared_ptr<const RangedBinding>& rangedBinding : *ranged)
+                if (EntryRangesContain(rangedBinding->ranges, entry) &&
+                    std::find(intervals.begin(), intervals.end(), rangedBinding->binding.interval) == intervals.end())
+                    intervals.push_back(rangedBinding->binding.interval);
+    }
+
+    /*
+     * Push all Lua references for `key` onto the stack.
+     *
+     * If `interval` is given, only the bindings with that update interval are pushed.
+     * Filtered bindings are only pushed if `context` is given and matches their filter.
+     *
+     * Ranged bindings containing the key's entry are pushed after the ones bound to the key itself.
+     *
+     * Only the snapshot lookup locks, bindings that run out of shots are removed afterwards.
+     *   Like everything else touching Lua this runs under the state lock, which keeps
+     *   bindings from being removed (and their references released) while pushing.
+     */
+    void PushRefsFor(const K& key, uint32 interval = BINDING_INTERVAL_ANY, const BindingFilterContext* context = nullptr)
+    {
+        SharedBindingSnapshot snapshot;
+        RangedBindingSnapshot ranged;
+        if (!GetSnapshots(key, snapshot, ranged))
             return;
 
-        BindingList& list = result->second;
-        for (auto i = list.begin(); i != list.end();)
-        {
-            std::unique_ptr<Binding>& binding = (*i);
-            auto i_prev = (i++);
+        if (snapshot && PushSharedBindingRefs(L, *snapshot, interval, context))
+            CompactSpent(key);
 
-            lua_rawgeti(L, LUA_REGISTRYINDEX, binding->functionReference);
+        uint32 entry;
+        if (!ranged || !KeyEntry(key, entry))
+            return;
 
-            if (binding->remainingShots > 0)
-            {
-                binding->remainingShots -= 1;
+        bool spent = false;
+        for (const std::shared_ptr<const RangedBinding>& rangedBinding : *ranged)
+        {
+            const SharedBinding& binding = rangedBinding->binding;
+            if (interval != BINDING_INTERVAL_ANY && binding.interval != interval)
+                continue;
 
-                if (binding->remainingShots == 0)
-                {
-                    id_lookup_table.erase(binding->id);
-                    list.erase(i_prev);
-                }
-            }
+            if (!binding.Accepts(context) || !EntryRangesContain(rangedBinding->ranges, entry) || !binding.TakeShot())
+                continue;
+
+            lua_rawgeti(L, LUA_REGISTRYINDEX, binding.functionReference);
+            if (binding.IsSpent())
+                spent = true;
         }
+
+        if (spent)
+            CompactSpentRanged(static_cast<uint32>(key.event_id));
     }
 };
 
@@ -227,6 +1225,278 @@ struct EventKey
     { }
 };
 
+/*
+ * `BindingMap` specialization for `EventKey`s.
+ *
+ * Event IDs are small and contiguous, so the binding list snapshots are stored in a flat
+ *   array indexed by event ID instead of a hash map. The event ID is encoded in the binding ID,
+ *   so no ID lookup table is needed either.
+ */
+template<typename T>
+class BindingMap< EventKey<T> > : public ALEUtil::Lockable, public BindingPresence
+{
+private:
+    lua_State* L;
+    uint32 maxBindingSeq;
+
+    // Indexed by event ID, grown on demand. Event IDs without bindings have no snapshot
+    std::vector< std::shared_ptr<SharedBindingList> > bindings;
+
+    static uint32 EventIdFor(uint64 id) { return static_cast<uint32>(id); }
+
+    // Changes whenever a binding is added or removed, see `GetGeneration`
+    std::atomic<uint64> generation;
+
+    void BumpGeneration()
+    {
+        generation.store(NextBindingGeneration(), std::memory_order_release);
+    }
+
+    void Unref(const SharedBinding& binding)
+    {
+        luaL_unref(L, LUA_REGISTRYINDEX, binding.functionReference);
+    }
+
+    void Publish(uint32 event_id, std::shared_ptr<SharedBindingList> list)
+    {
+        if (list->empty())
+            bindings[event_id].reset();
+        else
+            bindings[event_id] = std::move(list);
+        BumpGeneration();
+    }
+
+    SharedBindingSnapshot GetSnapshot(uint32 event_id)
+    {
+        Guard guard(GetLock());
+
+        if (bindings.size() <= event_id)
+            return nullptr;
+
+        return bindings[event_id];
+    }
+
+    /*
+     * Remove the spent bindings of `event_id`, called after pushing its references used up a binding's last shot.
+     */
+    void CompactSpent(uint32 event_id)
+    {
+        Guard guard(GetLock());
+
+        if (bindings.size() <= event_id || !bindings[event_id])
+            return;
+
+        std::shared_ptr<SharedBindingList> list = std::make_shared<SharedBindingList>();
+        uint32 spent = 0;
+        for (const SharedBinding& binding : *bindings[event_id])
+        {
+            if (!binding.IsSpent())
+            {
+                list->push_back(binding);
+                continue;
+            }
+
+            Unref(binding);
+            ++spent;
+        }
+
+        // Another push already compacted the list
+        if (!spent)
+            return;
+
+        RemovePresence(event_id, spent);
+        Publish(event_id, list);
+    }
+
+public:
+    BindingMap(lua_State* L) :
+        L(L),
+        maxBindingSeq(0),
+        generation(NextBindingGeneration())
+    { }
+
+    ~BindingMap()
+    {
+        for (std::shared_ptr<SharedBindingList>& list : bindings)
+            if (list)
+                for (const SharedBinding& binding : *list)
+                    Unref(binding);
+    }
+
+    /*
+     * Insert a new binding from `key` to `ref`, which lasts for `shots`-many pushes.
+     *
+     * If `shots` is 0, it will never automatically expire, but can still be
+     *   removed with `Clear` or `Remove`.
+     *
+     * `interval` is the update interval of bindings to update hooks, see `GetIntervalsFor`.
+     *
+     * If `filter` is given, the binding is only called for events that match it, see `PushRefsFor`.
+     */
+    uint64 Insert(const EventKey<T>& key, int ref, uint32 shots, uint32 interval = 0, std::shared_ptr<const BindingFilter> filter = nullptr)
+    {
+        Guard guard(GetLock());
+
+        uint32 event_id = key.event_id;
+        if (bindings.size() <= event_id)
+            bindings.resize(event_id + 1);
+
+        // The low 32 bits of the ID are the event ID, used by `Remove` to find the list
+        uint64 id = (uint64(++maxBindingSeq) << 32) | event_id;
+        AppendableBindingList(bindings[event_id]).emplace_back(id, ref, shots, interval, std::move(filter));
+
+        AddPresence(event_id, 1);
+        BumpGeneration();
+        return id;
+    }
+
+    /*
+     * Clear all bindings for `key`.
+     */
+    void Clear(const EventKey<T>& key)
+    {
+        Guard guard(GetLock());
+
+        uint32 event_id = key.event_id;
+        if (bindings.size() <= event_id || !bindings[event_id])
+            return;
+
+        const SharedBindingList& list = *bindings[event_id];
+        for (const SharedBinding& binding : list)
+            Unref(binding);
+
+        RemovePresence(event_id, list.size());
+        bindings[event_id].reset();
+        BumpGeneration();
+    }
+
+    /*
+     * Clear all bindings for all keys.
+     */
+    void Clear()
+    {
+        Guard guard(GetLock());
+
+        for (std::shared_ptr<SharedBindingList>& list : bindings)
+            if (list)
+                for (const SharedBinding& binding : *list)
+                    Unref(binding);
+
+        bindings.clear();
+        ClearPresence();
+        BumpGeneration();
+    }
+
+    /*
+     * Remove a specific binding identified by `id`.
+     *
+     * If `id` in invalid, nothing is removed.
+     */
+    void Remove(uint64 id)
+    {
+        Guard guard(GetLock());
+
+        uint32 event_id = EventIdFor(id);
+        if (bindings.size() <= event_id || !bindings[event_id])
+            return;
+
+        std::shared_ptr<SharedBindingList> list = std::make_shared<SharedBindingList>();
+        bool removed = false;
+        for (const SharedBinding& binding : *bindings[event_id])
+        {
+            if (binding.id != id)
+            {
+                list->push_back(binding);
+                continue;
+            }
+
+            Unref(binding);
+            removed = true;
+        }
+
+        if (!removed)
+            return;
+
+        RemovePresence(event_id, 1);
+        Publish(event_id, list);
+    }
+
+    /*
+     * Check whether `key` has any bindings.
+     */
+    bool HasBindingsFor(const EventKey<T>& key)
+    {
+        uint32 event_id = key.event_id;
+        if (event_id < PRESENCE_BITS)
+            return HasBindingsForEvent(event_id);
+
+        Guard guard(GetLock());
+        return bindings.size() > event_id && bindings[event_id];
+    }
+
+    /*
+     * Returns a value that changes whenever bindings are added or removed, see the generic `GetGeneration`.
+     */
+    uint64 GetGeneration() const
+    {
+        return generation.load(std::memory_order_acquire);
+    }
+
+    /*
+     * Append the update intervals of the bindings for `key` to `intervals`, skipping the ones already in it.
+     */
+    void GetIntervalsFor(const EventKey<T>& key, std::vector<uint32>& intervals)
+    {
+        SharedBindingSnapshot snapshot = GetSnapshot(key.event_id);
+        if (!snapshot)
+            return;
+
+        for (const SharedBinding& binding : *snapshot)
+            if (std::find(intervals.begin(), intervals.end(), binding.interval) == intervals.end())
+                intervals.push_back(binding.interval);
+    }
+
+    /*
+     * Push all Lua references for `key` onto the stack.
+     *
+     * If `interval` is given, only the bindings with that update interval are pushed.
+     *
+     * Filtered bindings are only pushed if `context` is given and matches their filter.
+     *
+     * See the generic `PushRefsFor` for how this avoids holding the lock.
+     */
+    void PushRefsFor(const EventKey<T>& key, uint32 interval = BINDING_INTERVAL_ANY, const BindingFilterContext* context = nullptr)
+    {
+        uint32 event_id = key.event_id;
+        SharedBindingSnapshot snapshot = GetSnapshot(event_id);
+        if (!snapshot)
+            return;
+
+        if (PushSharedBindingRefs(L, *snapshot, interval, context))
+            CompactSpent(event_id);
+    }
+
+    /*
+     * Check whether any binding for `key` accepts the event described by `context`.
+     *
+     * Lets hooks with filtered bindings skip the state lock and pushing their arguments when no filter matches.
+     */
+    bool HasBindingsFor(const EventKey<T>& key, const BindingFilterContext& context)
+    {
+        if (!HasBindingsFor(key))
+            return false;
+
+        SharedBindingSnapshot snapshot = GetSnapshot(key.event_id);
+        if (!snapshot)
+            return false;
+
+        for (const SharedBinding& binding : *snapshot)
+            if (binding.Accepts(&context) && !binding.IsSpent())
+                return true;
+        return false;
+    }
+};
+
 /*
  * A `BindingMap` key type for event ID/Object entry ID bindings
  *   (CreatureEvents, GameObjectEvents, etc.).
@@ -261,6 +1531,56 @@ struct UniqueObjectKey
     { }
 };
 
+/*
+ * Index of `key` in a `BindingMap`'s key presence bits.
+ *
+ * Returns false if the key is not tracked.
+ */
+template <typename T>
+inline bool KeyPresenceIndex(const EntryKey<T>& key, uint32 events, uint32 entries, uint32& index)
+{
+    if (static_cast<uint32>(key.event_id) >= events || key.entry >= entries)
+        return false;
+
+    index = static_cast<uint32>(key.event_id) * entries + key.entry;
+    return true;
+}
+
+template <typename T>
+inline bool KeyPresenceIndex(const UniqueObjectKey<T>& /*key*/, uint32 /*events*/, uint32 /*entries*/, uint32& /*index*/)
+{
+    return false;
+}
+
+/*
+ * Entry of `key`, for the ranged bindings of a `BindingMap`.
+ *
+ * Returns false if the key type has no entry.
+ */
+template <typename T>
+inline bool KeyEntry(const EntryKey<T>& key, uint32& entry)
+{
+    entry = key.entry;
+    return true;
+}
+
+template <typename T>
+inline bool KeyEntry(const UniqueObjectKey<T>& /*key*/, uint32& /*entry*/)
+{
+    return false;
+}
+
+template <typename T>
+inline void SetKeyEntry(EntryKey<T>& key, uint32 entry)
+{
+    key.entry = entry;
+}
+
+template <typename T>
+inline void SetKeyEntry(UniqueObjectKey<T>& /*key*/, uint32 /*entry*/)
+{
+}
+
 class hash_helper
 {
 public:
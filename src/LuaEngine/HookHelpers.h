@@ -13,10 +13,13 @@
 /*
  * Sets up the stack so that event handlers can be called.
  *
+ * If `interval` is given, only the handlers with that update interval are set up.
+ * Handlers registered with a filter are only set up if `filterContext` is given and matches it.
+ *
  * Returns the number of functions that were pushed onto the stack.
  */
 template<typename K1, typename K2>
-int ALE::SetupStack(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, int number_of_arguments)
+int ALE::SetupStack(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, int number_of_arguments, uint32 interval/* = BINDING_INTERVAL_ANY*/, const BindingFilterContext* filterContext/* = nullptr*/)
 {
     ASSERT(number_of_arguments == this->push_counter);
     ASSERT(key1.event_id == key2.event_id);
@@ -34,9 +37,9 @@ int ALE::SetupStack(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const
     lua_insert(L, first_argument_index);
     // Stack: event_id, [arguments]
 
-    bindings1->PushRefsFor(key1);
+    bindings1->PushRefsFor(key1, interval, filterContext);
     if (bindings2)
-        bindings2->PushRefsFor(key2);
+        bindings2->PushRefsFor(key2, interval, filterContext);
     // Stack: event_id, [arguments], [functions]
 
     int number_of_functions = lua_gettop(L) - arguments_top;
@@ -63,12 +66,12 @@ void ALE::ReplaceArgument(T value, uint8 index)
  * Call all event handlers registered to the event ID/entry combination and ignore any results.
  */
 template<typename K1, typename K2>
-void ALE::CallAllFunctions(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2)
+void ALE::CallAllFunctions(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, const BindingFilterContext* filterContext/* = nullptr*/)
 {
     int number_of_arguments = this->push_counter;
     // Stack: [arguments]
 
-    int number_of_functions = SetupStack(bindings1, bindings2, key1, key2, number_of_arguments);
+    int number_of_functions = SetupStack(bindings1, bindings2, key1, key2, number_of_arguments, BINDING_INTERVAL_ANY, filterContext);
     // Stack: event_id, [arguments], [functions]
 
     while (number_of_functions > 0)
@@ -89,14 +92,14 @@ void ALE::CallAllFunctions(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2,
  *   otherwise returns the opposite of `default_value`.
  */
 template<typename K1, typename K2>
-bool ALE::CallAllFunctionsBool(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, bool default_value/* = false*/)
+bool ALE::CallAllFunctionsBool(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, bool default_value/* = false*/, uint32 interval/* = BINDING_INTERVAL_ANY*/, const BindingFilterContext* filterContext/* = nullptr*/)
 {
     bool result = default_value;
     // Note: number_of_arguments here does not count in eventID, which is pushed in SetupStack
     int number_of_arguments = this->push_counter;
     // Stack: [arguments]
 
-    int number_of_functions = SetupStack(bindings1, bindings2, key1, key2, number_of_arguments);
+    int number_of_functions = SetupStack(bindings1, bindings2, key1, key2, number_of_arguments, interval, filterContext);
     // Stack: event_id, [arguments], [functions]
 
     while (number_of_functions > 0)
@@ -118,4 +121,54 @@ bool ALE::CallAllFunctionsBool(BindingMap<K1>* bindings1, BindingMap<K2>* bindin
     return result;
 }
 
+/*
+ * Call the update handlers registered to the event ID/entry combination, grouped by their update interval.
+ *
+ * `push_arguments` pushes the arguments that come before the elapsed time, which is always the last argument.
+ * Handlers without an interval are called with `diff` on every update, the others only once their interval
+ *   has passed on `timers`, with the time since they were last called.
+ * `timers` also caches the intervals of the bindings, so it has to belong to a single object and keys.
+ *
+ * Returns true if any handler returned true.
+ */
+template<typename K1, typename K2, typename F>
+bool ALE::CallUpdateFunctions(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, ALEUpdateTimers& timers, uint32 diff, F push_arguments)
+{
+    timers.Update(diff);
+
+    // The intervals are only looked up again after bindings changed, most ticks don't lock or allocate for them
+    uint64 generation1 = bindings1->GetGeneration();
+    uint64 generation2 = bindings2 ? bindings2->GetGeneration() : 0;
+    if (!timers.HasIntervalsFor(generation1, generation2))
+    {
+        // The generations are read first, changes after this are picked up on the next update
+        std::vector<uint32>& intervals = timers.ResetIntervals(generation1, generation2);
+        bindings1->GetIntervalsFor(key1, intervals);
+        if (bindings2)
+            bindings2->GetIntervalsFor(key2, intervals);
+    }
+
+    bool result = false;
+    for (uint32 interval : timers.GetIntervals())
+    {
+        uint32 elapsed = diff;
+        if (interval && !timers.IsDue(interval, elapsed))
+        {
+            // Handlers that returned true keep doing so until they are called again
+            if (timers.GetLastResult(interval))
+                result = true;
+            continue;
+        }
+
+        push_arguments();
+        Push(elapsed);
+        bool intervalResult = CallAllFunctionsBool(bindings1, bindings2, key1, key2, false, interval);
+        if (interval)
+            timers.SetLastResult(interval, intervalResult);
+        if (intervalResult)
+            result = true;
+    }
+    return result;
+}
+
 #endif // _HOOK_HELPERS_H
@@ -36,7 +36,6 @@ HttpManager::HttpManager()
     condVarMutex(),
     parseUrlRegex("^(([^:/?#]+):)?(//([^/?#]*))?([^?#]*)(\\?([^#]*))?(#(.*))?")
 {
-    StartHttpWorker();
 }
 
 HttpManager::~HttpManager()
@@ -46,6 +45,10 @@ HttpManager::~HttpManager()
 
 void HttpManager::PushRequest(HttpWorkItem* item)
 {
+    // The worker is started on first use, map states that never send requests don't need a thread
+    if (!startedWorkerThread)
+        StartHttpWorker();
+
     std::unique_lock<std::mutex> lock(condVarMutex);
     workQueue.push(item);
     condVar.notify_one();
@@ -236,7 +239,7 @@ bool HttpManager::ParseUrl(const std::string& url, std::string& host, std::strin
     return true;
 }
 
-void HttpManager::HandleHttpResponses()
+void HttpManager::HandleHttpResponses(ALE* E)
 {
     while (!responseQueue.empty())
     {
@@ -248,9 +251,9 @@ void HttpManager::HandleHttpResponses()
             continue;
         }
 
-        LOCK_ALE;
+        ALE::Guard guard(E->GetStateLock());
 
-        lua_State* L = ALE::GALE->L;
+        lua_State* L = E->L;
 
         // Get function
         lua_rawgeti(L, LUA_REGISTRYINDEX, res->funcRef);
@@ -266,7 +269,7 @@ void HttpManager::HandleHttpResponses()
         }
 
         // Call function
-        ALE::GALE->ExecuteCall(3, 0);
+        E->ExecuteCall(3, 0);
 
         luaL_unref(L, LUA_REGISTRYINDEX, res->funcRef);
 
@@ -6,6 +6,8 @@
 #include "libs/httplib.h"
 #include "libs/rigtorp/SPSCQueue.h"
 
+class ALE;
+
 struct HttpWorkItem
 {
 public:
@@ -40,7 +42,8 @@ public:
     void StartHttpWorker();
     void StopHttpWorker();
     void PushRequest(HttpWorkItem* item);
-    void HandleHttpResponses();
+    // Calls the response callbacks in the state owning this manager
+    void HandleHttpResponses(ALE* E);
 
 private:
     void ClearQueues();
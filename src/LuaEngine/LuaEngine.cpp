@@ -15,6 +15,8 @@
 #include "ALEUtility.h"
 #include "ALECreatureAI.h"
 #include "ALEInstanceAI.h"
+#include "CryptoHash.h"
+#include "Util.h"
 
 #if AC_PLATFORM == AC_PLATFORM_WINDOWS
 #define ALE_WINDOWS
@@ -30,6 +32,18 @@
 #include <ctime>
 #include <sys/stat.h>
 #include <unordered_map>
+#include <unordered_set>
+#include <thread>
+#include <algorithm>
+#include <sstream>
+#include <cstdio>
+#include <iterator>
+
+#ifndef ALE_WINDOWS
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 extern "C"
 {
@@ -46,19 +60,122 @@ ALE::ScriptList ALE::lua_extensions;
 std::string ALE::lua_folderpath;
 std::string ALE::lua_requirepath;
 std::string ALE::lua_requirecpath;
+std::string ALE::lua_bytecodepath;
 ALE* ALE::GALE = NULL;
 bool ALE::reload = false;
+bool ALE::reloadChangesKnown = false;
+std::set<std::string> ALE::reloadChangedFiles;
 bool ALE::initialized = false;
+bool ALE::multiState = false;
+bool ALE::scriptsLoaded = false;
 ALE::LockType ALE::lock;
 std::unique_ptr<ALEFileWatcher> ALE::fileWatcher;
+std::shared_ptr<ALEScriptArchive> ALE::scriptArchive;
+std::shared_ptr<const ALE::ModuleIndex> ALE::moduleIndex;
+std::unordered_map<Map const*, ALE*> ALE::mapStates;
+std::shared_mutex ALE::mapStatesLock;
+static std::atomic<uint32> typeIdCounter(0);
 
 // Global bytecode cache that survives ALE reloads
 static std::unordered_map<std::string, GlobalCacheEntry> globalBytecodeCache;
 static std::unordered_map<std::string, std::time_t> timestampCache;
 static std::mutex globalCacheMutex;
 
+// Bytecode is only valid for the Lua build that produced it
+#ifndef ALE_LUA_VERSION
+#define ALE_LUA_VERSION LUA_VERSION
+#endif
+
+static bool ReadSourceFile(const std::string& filepath, std::string& source)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    source.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad();
+}
+
+// Returns the on-disk cache file for the script at `filepath` with the given source.
+// The path is part of the key as the bytecode embeds it as the chunk name used in errors and debug info.
+static std::string GetBytecodeCacheFile(const std::string& folder, const std::string& filepath, const std::string& source, bool isMoonScript)
+{
+    Acore::Crypto::SHA256 hash;
+    hash.UpdateData(ALE_LUA_VERSION);
+    hash.UpdateData(LUA_RELEASE);
+    hash.UpdateData(fmt::format("|{}|{}|{}|{}|{}|", sizeof(void*), sizeof(lua_Number), isMoonScript ? "moon" : "lua", filepath.size(), filepath));
+    hash.UpdateData(source);
+    hash.Finalize();
+    return folder + "/" + ByteArrayToHexStr(hash.GetDigest()) + ".luac";
+}
+
+static bool ReadBytecodeFile(const std::string& cachepath, BytecodeBuffer& bytecode)
+{
+#ifdef ALE_WINDOWS
+    std::ifstream file(cachepath, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    bytecode.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return !file.bad() && !bytecode.empty();
+#else
+    int fd = open(cachepath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat fileInfo;
+    if (fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(fileInfo.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+        return false;
+
+    const uint8* bytes = static_cast<const uint8*>(data);
+    bytecode.assign(bytes, bytes + size);
+    munmap(data, size);
+    return true;
+#endif
+}
+
+static void WriteBytecodeFile(const std::string& cachepath, const BytecodeBuffer& bytecode)
+{
+    // Written next to the final file and renamed over it, so other threads and servers sharing
+    // the folder never read a partial file
+    std::ostringstream tmppath;
+    tmppath << cachepath << ".tmp." << std::this_thread::get_id();
+
+    {
+        std::ofstream file(tmppath.str(), std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+            return;
+        file.write(reinterpret_cast<const char*>(bytecode.data()), bytecode.size());
+        if (!file.good())
+        {
+            file.close();
+            std::remove(tmppath.str().c_str());
+            return;
+        }
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(tmppath.str(), cachepath, ec);
+    if (ec)
+        std::remove(tmppath.str().c_str());
+}
+
 extern void RegisterFunctions(ALE* E);
 
+static bool ScriptPathComparator(const LuaScript& first, const LuaScript& second)
+{
+    return first.filepath < second.filepath;
+}
+
 void ALE::Initialize()
 {
     LOCK_ALE;
@@ -70,6 +187,11 @@ void ALE::Initialize()
 
     LoadScriptPaths();
 
+    // Changing this requires a restart, maps keep the state they were created with
+    multiState = ALEConfig::GetInstance().IsMultiStateEnabled();
+    if (multiState)
+        ALE_LOG_INFO("[ALE]: Multistate enabled, maps use their own Lua states");
+
     // Must be before creating GALE
     // This is checked on ALE creation
     initialized = true;
@@ -98,11 +220,21 @@ void ALE::Uninitialize()
         fileWatcher.reset();
     }
 
+    {
+        std::unique_lock<std::shared_mutex> mapLock(mapStatesLock);
+        for (auto& itr : mapStates)
+            delete itr.second;
+        mapStates.clear();
+    }
+
     delete GALE;
     GALE = NULL;
+    scriptsLoaded = false;
 
     lua_scripts.clear();
     lua_extensions.clear();
+    scriptArchive.reset();
+    moduleIndex.reset();
 
     // Clear global cache on shutdown
     ClearGlobalCache();
@@ -128,12 +260,37 @@ void ALE::LoadScriptPaths()
 #endif
     ALE_LOG_INFO("[ALE]: Searching scripts from `{}`", lua_folderpath);
 
+    lua_bytecodepath = ALEConfig::GetInstance().GetByteCodeCachePath();
+    if (!lua_bytecodepath.empty())
+    {
+#ifndef ALE_WINDOWS
+        if (lua_bytecodepath[0] == '~')
+            if (const char* home = getenv("HOME"))
+                lua_bytecodepath.replace(0, 1, home);
+#endif
+        boost::system::error_code ec;
+        boost::filesystem::create_directories(lua_bytecodepath, ec);
+        if (ec)
+        {
+            ALE_LOG_ERROR("[ALE]: Could not create bytecode cache folder `{}`: {}", lua_bytecodepath, ec.message());
+            lua_bytecodepath.clear();
+        }
+    }
+
     // clear all cache variables
     lua_requirepath.clear();
     lua_requirecpath.clear();
 
     GetScripts(lua_folderpath);
 
+    std::string archivePath = static_cast<std::string>(ALEConfig::GetInstance().GetScriptArchive());
+#ifndef ALE_WINDOWS
+    if (!archivePath.empty() && archivePath[0] == '~')
+        if (const char* home = getenv("HOME"))
+            archivePath.replace(0, 1, home);
+#endif
+    AddArchiveScripts(archivePath);
+
     // append our custom require paths and cpaths if the config variables are not empty
     if (!lua_path_extra.empty())
         lua_requirepath += lua_path_extra;
@@ -148,9 +305,27 @@ void ALE::LoadScriptPaths()
     if (!lua_requirecpath.empty())
         lua_requirecpath.erase(lua_requirecpath.end() - 1);
 
+    // Sorted here so that map states can run the lists concurrently without modifying them
+    lua_extensions.sort(ScriptPathComparator);
+    lua_scripts.sort(ScriptPathComparator);
+
+    BuildModuleIndex();
+
     ALE_LOG_DEBUG("[ALE]: Loaded {} scripts in {} ms", lua_scripts.size() + lua_extensions.size(), ALEUtil::GetTimeDiff(oldMSTime));
 }
 
+void ALE::ReloadALE(const std::set<std::string>& changedFiles)
+{
+    LOCK_ALE;
+    // A reload without known changes is already pending, it checks every file anyway
+    if (reload && !reloadChangesKnown)
+        return;
+
+    reload = true;
+    reloadChangesKnown = true;
+    reloadChangedFiles.insert(changedFiles.begin(), changedFiles.end());
+}
+
 void ALE::_ReloadALE()
 {
     LOCK_ALE;
@@ -167,6 +342,15 @@ void ALE::_ReloadALE()
     // Close lua
     sALE->CloseLua();
 
+    // Forget the timestamps of the changed files, or all of them if the changes are not known.
+    // Map states load with the same timestamps on their own reload.
+    if (reloadChangesKnown)
+        ClearTimestampCache(reloadChangedFiles);
+    else
+        ClearTimestampCache();
+    reloadChangedFiles.clear();
+    reloadChangesKnown = false;
+
     // Reload script paths
     LoadScriptPaths();
 
@@ -176,12 +360,95 @@ void ALE::_ReloadALE()
     // Run scripts from laoded paths
     sALE->RunScripts();
 
+    // Map states reload on their own map update, the script lists are not modified until the next reload
+    {
+        std::shared_lock<std::shared_mutex> mapLock(mapStatesLock);
+        for (auto& itr : mapStates)
+            itr.second->reloadPending = true;
+    }
+
     reload = false;
 }
 
-ALE::ALE() :
+void ALE::ReloadMapState()
+{
+    LOCK_ALE_STATE;
+    ASSERT(boundMap);
+
+    reloadPending = false;
+
+    eventMgr->SetStates(LUAEVENT_STATE_ERASE);
+    CloseLua();
+    OpenLua();
+    RunScripts();
+}
+
+ALE* ALE::GetStateFor(Map const* map)
+{
+    if (!multiState || !map)
+        return GALE;
+
+    std::shared_lock<std::shared_mutex> mapLock(mapStatesLock);
+    auto itr = mapStates.find(map);
+    return itr != mapStates.end() ? itr->second : GALE;
+}
+
+ALE** ALE::GetStatePtrFor(Map const* map)
+{
+    if (!multiState || !map)
+        return &GALE;
+
+    std::shared_lock<std::shared_mutex> mapLock(mapStatesLock);
+    auto itr = mapStates.find(map);
+    return itr != mapStates.end() ? &itr->second->self : &GALE;
+}
+
+void ALE::CreateMapState(Map* map)
+{
+    if (!multiState || !IsInitialized())
+        return;
+
+    ALE* E = new ALE(map);
+    {
+        std::unique_lock<std::shared_mutex> mapLock(mapStatesLock);
+        ASSERT(mapStates.find(map) == mapStates.end());
+        mapStates[map] = E;
+    }
+
+    // Maps created before the world state ran its scripts load them on their first update
+    if (scriptsLoaded)
+        E->RunScripts();
+    else
+        E->reloadPending = true;
+}
+
+void ALE::DestroyMapState(Map* map)
+{
+    if (!multiState || !IsInitialized())
+        return;
+
+    ALE* E = NULL;
+    {
+        std::unique_lock<std::shared_mutex> mapLock(mapStatesLock);
+        auto itr = mapStates.find(map);
+        if (itr == mapStates.end())
+            return;
+        E = itr->second;
+        mapStates.erase(itr);
+    }
+
+    // The map is no longer updated, nothing else can be using its state
+    delete E;
+}
+
+ALE::ALE(Map* map) :
+self(this),
+boundMap(map),
+reloadPending(false),
 event_level(0),
 push_counter(0),
+objectCacheRef(LUA_NOREF),
+hasGameObjectUpdateTimers(false),
 
 L(NULL),
 eventMgr(NULL),
@@ -215,11 +482,9 @@ CreatureUniqueBindings(NULL)
 
     OpenLua();
 
-    // Replace this with map insert if making multithread version
-
     // Set event manager. Must be after setting sALE
-    // on multithread have a map of state pointers and here insert this pointer to the map and then save a pointer of that pointer to the EventMgr
-    eventMgr = new EventMgr(&ALE::GALE);
+    // Map states are not stored in GALE, their event processors use the self pointer instead
+    eventMgr = new EventMgr(boundMap ? &self : &ALE::GALE);
 }
 
 ALE::~ALE()
@@ -238,13 +503,19 @@ void ALE::CloseLua()
 
     DestroyBindStores();
 
+    coroutineScheduler.Clear();
+
     // Must close lua state after deleting stores and mgr
     if (L)
         lua_close(L);
     L = NULL;
+    objectCacheRef = LUA_NOREF;
+    metatableRefs.clear();
 
     instanceDataRefs.clear();
     continentDataRefs.clear();
+    gameObjectUpdateTimers.clear();
+    mapUpdateTimers.clear();
 }
 
 void ALE::OpenLua()
@@ -260,6 +531,14 @@ void ALE::OpenLua()
     lua_pushlightuserdata(L, this);
     lua_setfield(L, LUA_REGISTRYINDEX, ALE_STATE_PTR);
 
+    // Userdata reuse cache, the values are weak so unreferenced userdata can still be collected
+    lua_newtable(L);
+    lua_newtable(L);
+    lua_pushstring(L, "v");
+    lua_setfield(L, -2, "__mode");
+    lua_setmetatable(L, -2);
+    objectCacheRef = luaL_ref(L, LUA_REGISTRYINDEX);
+
     CreateBindStores();
 
     // open base lua libraries
@@ -284,8 +563,23 @@ void ALE::OpenLua()
         lua_pop(L, 1);
         lua_getfield(L, -1, "searchers");
     }
+    // Stack: package, searchers
 
-    lua_pop(L, 1);
+    // Script modules are searched right after package.preload, before package.path
+    archive = scriptArchive;
+    modules = moduleIndex;
+    if (lua_istable(L, -1))
+    {
+        for (int i = static_cast<int>(lua_rawlen(L, -1)); i >= 2; --i)
+        {
+            lua_rawgeti(L, -1, i);
+            lua_rawseti(L, -2, i + 1);
+        }
+        lua_pushcfunction(L, &ModuleSearcher);
+        lua_rawseti(L, -2, 2);
+    }
+
+    lua_pop(L, 2);
 }
 
 void ALE::CreateBindStores()
@@ -301,7 +595,7 @@ void ALE::CreateBindStores()
     TicketEventBindings      = new BindingMap< EventKey<Hooks::TicketEvents> >(L);
     AllCreatureEventBindings = new BindingMap< EventKey<Hooks::AllCreatureEvents> >(L);
 
-    PacketEventBindings      = new BindingMap< EntryKey<Hooks::PacketEvents> >(L);
+    PacketEventBindings      = new BindingMap< EntryKey<Hooks::PacketEvents> >(L, Hooks::PACKET_EVENT_COUNT, NUM_MSG_TYPES);
     CreatureEventBindings    = new BindingMap< EntryKey<Hooks::CreatureEvents> >(L);
     CreatureGossipBindings   = new BindingMap< EntryKey<Hooks::GossipEvents> >(L);
     GameObjectEventBindings  = new BindingMap< EntryKey<Hooks::GameObjectEvents> >(L);
@@ -363,7 +657,7 @@ void ALE::DestroyBindStores()
     CreatureUniqueBindings = NULL;
 }
 
-void ALE::AddScriptPath(std::string filename, const std::string& fullpath)
+void ALE::AddScriptPath(std::string filename, const std::string& fullpath, const ALEScriptArchive::Entry* archiveEntry/* = nullptr*/)
 {
     ALE_LOG_DEBUG("[ALE]: AddScriptPath Checking file `{}`", fullpath);
 
@@ -384,6 +678,7 @@ void ALE::AddScriptPath(std::string filename, const std::string& fullpath)
     script.filename = filename;
     script.filepath = fullpath;
     script.modulepath = fullpath.substr(0, fullpath.length() - filename.length() - ext.length());
+    script.archiveEntry = archiveEntry;
     if (extension)
         lua_extensions.push_back(script);
     else
@@ -391,6 +686,129 @@ void ALE::AddScriptPath(std::string filename, const std::string& fullpath)
     ALE_LOG_DEBUG("[ALE]: AddScriptPath add path `{}`", fullpath);
 }
 
+// Adds the scripts packed in the script archive, replacing the previously opened archive
+void ALE::AddArchiveScripts(const std::string& archivePath)
+{
+    scriptArchive.reset();
+    if (archivePath.empty())
+        return;
+
+    std::shared_ptr<ALEScriptArchive> newArchive = std::make_shared<ALEScriptArchive>();
+    if (!newArchive->Open(archivePath))
+        return;
+
+    ALE_LOG_INFO("[ALE]: Searching scripts from archive `{}`", archivePath);
+    for (const ALEScriptArchive::Entry& entry : newArchive->GetEntries())
+    {
+        std::size_t slash = entry.path.find_last_of('/');
+        std::string filename = slash == std::string::npos ? entry.path : entry.path.substr(slash + 1);
+
+        // MoonScript and native modules can't be loaded from memory, they must stay in the script folder
+        std::size_t extDot = filename.find_last_of('.');
+        std::string ext = extDot == std::string::npos ? "" : filename.substr(extDot);
+        if (ext != ".lua" && ext != ".ext" && ext != ".out")
+        {
+            ALE_LOG_DEBUG("[ALE]: Skipping `{}` in script archive `{}`", entry.path, archivePath);
+            continue;
+        }
+
+        AddScriptPath(filename, archivePath + "/" + entry.path, &entry);
+    }
+
+    scriptArchive = newArchive;
+}
+
+/*
+ * Indexes the scripts in the script folder by the names `require` finds them with,
+ *   so `require` doesn't have to probe a `package.path` entry for every folder.
+ *
+ * A script is found by its path relative to the script folder and by every shorter
+ *   trailing part of it, e.g. `utilities/helpers` and `helpers`.
+ * Like with `package.path`, `.lua` wins over `.moon` over `.ext`, then the first path in order.
+ */
+void ALE::BuildModuleIndex()
+{
+    std::shared_ptr<ModuleIndex> index = std::make_shared<ModuleIndex>();
+
+    static const char* const moduleExtensions[] = { ".lua", ".moon", ".ext", ".out" };
+    for (const char* ext : moduleExtensions)
+    {
+        for (const ScriptList* list : { &lua_extensions, &lua_scripts })
+        {
+            for (const LuaScript& script : *list)
+            {
+                if (script.archiveEntry || script.fileext != ext)
+                    continue;
+
+                std::string module = script.filepath.substr(0, script.filepath.length() - script.fileext.length());
+                if (module.compare(0, lua_folderpath.length(), lua_folderpath) == 0)
+                    module.erase(0, lua_folderpath.length());
+                if (!module.empty() && module[0] == '/')
+                    module.erase(0, 1);
+
+                index->emplace(module, script.filepath);
+                for (std::size_t slash = module.find('/'); slash != std::string::npos; slash = module.find('/', slash + 1))
+                    index->emplace(module.substr(slash + 1), script.filepath);
+            }
+        }
+    }
+
+    moduleIndex = index;
+}
+
+/*
+ * A `package.searchers` (`package.loaders` on Lua 5.1) entry that resolves modules
+ *   from the script archive, then from the script folder's module index.
+ *
+ * Folder scripts are loaded through the bytecode cache.
+ */
+int ALE::ModuleSearcher(lua_State* L)
+{
+    const char* name = luaL_checkstring(L, 1);
+    ALE* E = GetALE(L);
+
+    if (const ALEScriptArchive::Entry* entry = E->archive ? E->archive->FindModule(name) : nullptr)
+    {
+        if (E->archive->Load(L, *entry))
+            return luaL_error(L, "error loading module '%s' from script archive:\n\t%s", name, lua_tostring(L, -1));
+
+        lua_pushfstring(L, "%s/%s", E->archive->GetPath().c_str(), entry->path.c_str());
+        return 2;
+    }
+
+    int status;
+    {
+        std::string module = name;
+        std::replace(module.begin(), module.end(), '.', '/');
+
+        ModuleIndex::const_iterator it;
+        if (!E->modules || (it = E->modules->find(module)) == E->modules->end())
+        {
+            lua_pushfstring(L, "\n\tno module '%s' in script folder or archive", name);
+            return 1;
+        }
+
+        const std::string& filepath = it->second;
+        std::size_t extDot = filepath.find_last_of('.');
+        std::string ext = filepath.substr(extDot);
+        if (ext == ".out")
+            status = LoadCompiledScript(L, filepath);
+        else
+            status = LoadScriptWithCache(L, filepath, ext == ".moon");
+
+        // Stack: name, [extra], loader or errmsg
+        if (status)
+            lua_pushfstring(L, "error loading module '%s' from file '%s':\n\t%s", name, filepath.c_str(), lua_tostring(L, -1));
+        else
+            lua_pushstring(L, filepath.c_str());
+    }
+
+    // Raised outside the block above so no C++ objects are skipped by the longjmp
+    if (status)
+        return lua_error(L);
+    return 2;
+}
+
 std::time_t ALE::GetFileModTime(const std::string& filepath)
 {
     struct stat fileInfo;
@@ -410,29 +828,26 @@ std::time_t ALE::GetFileModTimeWithCache(const std::string& filepath)
     return modTime;
 }
 
-bool ALE::CompileScriptToGlobalCache(const std::string& filepath)
+bool ALE::CompileToBytecode(lua_State* tempL, const std::string& filepath, bool isMoonScript, BytecodeBuffer& bytecode)
 {
-    std::lock_guard<std::mutex> lock(globalCacheMutex);
-    
-    lua_State* tempL = luaL_newstate();
-    if (!tempL)
-        return false;
+    int top = lua_gettop(tempL);
+    int result;
+    if (isMoonScript)
+    {
+        std::string moonscriptLoader = "return require('moonscript').loadfile([[" + filepath + "]])";
+        result = luaL_loadstring(tempL, moonscriptLoader.c_str());
+        if (result == LUA_OK)
+            result = lua_pcall(tempL, 0, 1, 0);
+    }
+    else
+        result = luaL_loadfile(tempL, filepath.c_str());
 
-    int result = luaL_loadfile(tempL, filepath.c_str());
-    if (result != LUA_OK)
+    if (result != LUA_OK || !lua_isfunction(tempL, -1))
     {
-        lua_close(tempL);
+        lua_settop(tempL, top);
         return false;
     }
 
-    std::time_t modTime = GetFileModTime(filepath);
-    
-    auto& cacheEntry = globalBytecodeCache[filepath];
-    cacheEntry.last_modified = modTime;
-    cacheEntry.filepath = filepath;
-    cacheEntry.bytecode.clear();
-    cacheEntry.bytecode.reserve(1024);
-
     struct BytecodeWriter {
         BytecodeBuffer* buffer;
         static int writer(lua_State*, const void* p, size_t sz, void* ud) {
@@ -443,77 +858,177 @@ bool ALE::CompileScriptToGlobalCache(const std::string& filepath)
         }
     };
 
+    bytecode.clear();
+    bytecode.reserve(isMoonScript ? 2048 : 1024);
+
     BytecodeWriter writer;
-    writer.buffer = &cacheEntry.bytecode;
+    writer.buffer = &bytecode;
 
     int dumpResult = lua_dump(tempL, BytecodeWriter::writer, &writer);
-    if (dumpResult != LUA_OK || cacheEntry.bytecode.empty())
+    lua_settop(tempL, top);
+    return dumpResult == LUA_OK && !bytecode.empty();
+}
+
+void ALE::StoreInGlobalCache(const std::string& filepath, std::time_t modTime, BytecodeBuffer&& bytecode)
+{
+    std::lock_guard<std::mutex> lock(globalCacheMutex);
+
+    auto& cacheEntry = globalBytecodeCache[filepath];
+    cacheEntry.last_modified = modTime;
+    cacheEntry.filepath = filepath;
+    cacheEntry.bytecode = std::move(bytecode);
+}
+
+/*
+ * Fills `bytecode` for a script, from the on-disk cache if it has an entry for the script's
+ *   current content, otherwise by compiling it and adding it to the on-disk cache.
+ *
+ * `tempL` is only created when the script has to be compiled, the caller closes it.
+ */
+bool ALE::BuildBytecode(lua_State*& tempL, const std::string& filepath, bool isMoonScript, BytecodeBuffer& bytecode)
+{
+    std::string cachepath;
+    if (!lua_bytecodepath.empty())
+    {
+        std::string source;
+        if (ReadSourceFile(filepath, source))
+        {
+            cachepath = GetBytecodeCacheFile(lua_bytecodepath, filepath, source, isMoonScript);
+            if (ReadBytecodeFile(cachepath, bytecode))
+                return true;
+        }
+    }
+
+    if (!tempL)
     {
-        globalBytecodeCache.erase(filepath);
+        tempL = luaL_newstate();
+        if (!tempL)
+            return false;
+        if (isMoonScript)
+            luaL_openlibs(tempL);
+    }
+
+    if (!CompileToBytecode(tempL, filepath, isMoonScript, bytecode))
+        return false;
+
+    if (!cachepath.empty())
+        WriteBytecodeFile(cachepath, bytecode);
+    return true;
+}
+
+bool ALE::CompileToGlobalCache(const std::string& filepath, bool isMoonScript)
+{
+    std::time_t modTime = GetFileModTime(filepath);
+    lua_State* tempL = nullptr;
+    BytecodeBuffer bytecode;
+    bool compiled = BuildBytecode(tempL, filepath, isMoonScript, bytecode);
+    if (tempL)
         lua_close(tempL);
+
+    if (!compiled)
         return false;
-    }
 
-    lua_close(tempL);
+    StoreInGlobalCache(filepath, modTime, std::move(bytecode));
     return true;
 }
 
+bool ALE::CompileScriptToGlobalCache(const std::string& filepath)
+{
+    return CompileToGlobalCache(filepath, false);
+}
+
 bool ALE::CompileMoonScriptToGlobalCache(const std::string& filepath)
 {
-    std::lock_guard<std::mutex> lock(globalCacheMutex);
-    
-    lua_State* tempL = luaL_newstate();
-    if (!tempL)
-        return false;
+    return CompileToGlobalCache(filepath, true);
+}
 
-    luaL_openlibs(tempL);
+/*
+ * Compiles every `.lua`, `.ext` and `.moon` script in `scripts` that has no up to date
+ *   entry in the global bytecode cache, spread over a pool of worker threads.
+ * Scripts found in the on-disk cache are read from it instead of being compiled.
+ *
+ * Each worker keeps its own temporary lua_State for the whole run, so MoonScript is only
+ *   required once per worker. Only storing the result takes the cache lock.
+ * Scripts that fail to compile are left out of the cache so the serial load reports the error.
+ *
+ * The paths of the compiled scripts are inserted into `compiled`.
+ */
+void ALE::PrecompileScripts(const ScriptList& scripts, std::unordered_set<std::string>& compiled)
+{
+    struct CompileJob
+    {
+        const LuaScript* script;
+        std::time_t modTime;
+        bool isMoonScript;
+        bool compiled;
+    };
 
-    std::string moonscriptLoader = "return require('moonscript').loadfile([[" + filepath + "]])";
-    int result = luaL_loadstring(tempL, moonscriptLoader.c_str());
-    if (result != LUA_OK)
+    std::vector<CompileJob> jobs;
     {
-        lua_close(tempL);
-        return false;
+        std::lock_guard<std::mutex> lock(globalCacheMutex);
+        for (const LuaScript& script : scripts)
+        {
+            if (script.archiveEntry)
+                continue;
+
+            bool isMoonScript = script.fileext == ".moon";
+            if (!isMoonScript && script.fileext != ".lua" && script.fileext != ".ext")
+                continue;
+
+            std::time_t modTime = GetFileModTimeWithCache(script.filepath);
+            if (!modTime)
+                continue;
+
+            auto it = globalBytecodeCache.find(script.filepath);
+            if (it != globalBytecodeCache.end() && !it->second.bytecode.empty() && it->second.last_modified == modTime)
+                continue;
+
+            jobs.push_back({ &script, modTime, isMoonScript, false });
+        }
     }
 
-    result = lua_pcall(tempL, 0, 1, 0);
-    if (result != LUA_OK)
+    if (jobs.empty())
+        return;
+
+    std::atomic<size_t> nextJob(0);
+    auto worker = [&jobs, &nextJob]()
     {
-        lua_close(tempL);
-        return false;
-    }
+        lua_State* luaState = nullptr;
+        lua_State* moonState = nullptr;
 
-    std::time_t modTime = GetFileModTime(filepath);
-    
-    auto& cacheEntry = globalBytecodeCache[filepath];
-    cacheEntry.last_modified = modTime;
-    cacheEntry.filepath = filepath;
-    cacheEntry.bytecode.clear();
-    cacheEntry.bytecode.reserve(2048);
+        for (size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+        {
+            CompileJob& job = jobs[i];
+            lua_State*& tempL = job.isMoonScript ? moonState : luaState;
 
-    struct BytecodeWriter {
-        BytecodeBuffer* buffer;
-        static int writer(lua_State*, const void* p, size_t sz, void* ud) {
-            BytecodeWriter* w = static_cast<BytecodeWriter*>(ud);
-            const uint8* bytes = static_cast<const uint8*>(p);
-            w->buffer->insert(w->buffer->end(), bytes, bytes + sz);
-            return 0;
+            BytecodeBuffer bytecode;
+            if (!BuildBytecode(tempL, job.script->filepath, job.isMoonScript, bytecode))
+                continue;
+
+            StoreInGlobalCache(job.script->filepath, job.modTime, std::move(bytecode));
+            job.compiled = true;
         }
+
+        if (luaState)
+            lua_close(luaState);
+        if (moonState)
+            lua_close(moonState);
     };
 
-    BytecodeWriter writer;
-    writer.buffer = &cacheEntry.bytecode;
+    size_t threadCount = std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), jobs.size());
 
-    int dumpResult = lua_dump(tempL, BytecodeWriter::writer, &writer);
-    if (dumpResult != LUA_OK || cacheEntry.bytecode.empty())
-    {
-        globalBytecodeCache.erase(filepath);
-        lua_close(tempL);
-        return false;
-    }
+    // The calling thread compiles too, so only spawn the extra workers
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
 
-    lua_close(tempL);
-    return true;
+    for (const CompileJob& job : jobs)
+        if (job.compiled)
+            compiled.insert(job.script->filepath);
 }
 
 int ALE::TryLoadFromGlobalCache(lua_State* L, const std::string& filepath)
@@ -590,6 +1105,13 @@ void ALE::ClearTimestampCache()
     timestampCache.clear();
 }
 
+void ALE::ClearTimestampCache(const std::set<std::string>& filepaths)
+{
+    std::lock_guard<std::mutex> lock(globalCacheMutex);
+    for (const std::string& filepath : filepaths)
+        timestampCache.erase(filepath);
+}
+
 size_t ALE::GetGlobalCacheSize()
 {
     std::lock_guard<std::mutex> lock(globalCacheMutex);
@@ -623,11 +1145,6 @@ void ALE::GetScripts(std::string path)
 
     if (boost::filesystem::exists(someDir) && boost::filesystem::is_directory(someDir))
     {
-        lua_requirepath +=
-            path + "/?.lua;" +
-            path + "/?.moon;" +
-            path + "/?.ext;";
-        
         lua_requirecpath +=
             path + "/?.dll;" +
             path + "/?.so;";
@@ -664,14 +1181,9 @@ void ALE::GetScripts(std::string path)
     }
 }
 
-static bool ScriptPathComparator(const LuaScript& first, const LuaScript& second)
-{
-    return first.filepath < second.filepath;
-}
-
 void ALE::RunScripts()
 {
-    LOCK_ALE;
+    LOCK_ALE_STATE;
     if (!ALEConfig::GetInstance().IsALEEnabled())
         return;
 
@@ -681,16 +1193,19 @@ void ALE::RunScripts()
     uint32 cachedCount = 0;
     uint32 precompiledCount = 0;
     bool cacheEnabled = eConfigMgr->GetOption<bool>("ALE.BytecodeCache", true);
-    
-    if (cacheEnabled)
-        ClearTimestampCache();
 
     ScriptList scripts;
-    lua_extensions.sort(ScriptPathComparator);
-    lua_scripts.sort(ScriptPathComparator);
     scripts.insert(scripts.end(), lua_extensions.begin(), lua_extensions.end());
     scripts.insert(scripts.end(), lua_scripts.begin(), lua_scripts.end());
 
+    // Compile changed scripts in parallel up front, the loop below then only loads them from the cache
+    std::unordered_set<std::string> precompiled;
+    if (cacheEnabled)
+    {
+        PrecompileScripts(scripts, precompiled);
+        compiledCount = precompiled.size();
+    }
+
     std::unordered_map<std::string, std::string> loaded; // filename, path
 
     lua_getglobal(L, "package");
@@ -719,9 +1234,20 @@ void ALE::RunScripts()
         lua_pop(L, 1);
         // Stack: package, modules
 
-        if (it->fileext == ".moon")
+        if (it->archiveEntry)
         {
-            if (LoadScriptWithCache(L, it->filepath, true, &compiledCount, &cachedCount))
+            if (scriptArchive->Load(L, *it->archiveEntry))
+            {
+                // Stack: package, modules, errmsg
+                ALE_LOG_ERROR("[ALE]: Error loading `{}` from script archive", it->filepath);
+                Report(L);
+                // Stack: package, modules
+                continue;
+            }
+        }
+        else if (it->fileext == ".moon")
+        {
+            if (LoadScriptWithCache(L, it->filepath, true, &compiledCount, precompiled.count(it->filepath) ? nullptr : &cachedCount))
             {
                 // Stack: package, modules, errmsg
                 ALE_LOG_ERROR("[ALE]: Error loading MoonScript `{}`", it->filepath);
@@ -744,7 +1270,7 @@ void ALE::RunScripts()
         }
         else if (it->fileext == ".lua" || it->fileext == ".ext")
         {
-            if (LoadScriptWithCache(L, it->filepath, false, &compiledCount, &cachedCount))
+            if (LoadScriptWithCache(L, it->filepath, false, &compiledCount, precompiled.count(it->filepath) ? nullptr : &cachedCount))
             {
                 // Stack: package, modules, errmsg
                 ALE_LOG_ERROR("[ALE]: Error loading `{}`", it->filepath);
@@ -792,11 +1318,29 @@ void ALE::RunScripts()
     {
         details = fmt::format("({} compiled, {} cached, {} pre-compiled)", compiledCount, cachedCount, precompiledCount);
     }
-    ALE_LOG_INFO("[ALE]: Executed {} Lua scripts in {} ms {}", count, ALEUtil::GetTimeDiff(oldMSTime), details);
+    if (boundMap)
+        ALE_LOG_DEBUG("[ALE]: Executed {} Lua scripts for map {} instance {} in {} ms {}", count, boundMap->GetId(), boundMap->GetInstanceId(), ALEUtil::GetTimeDiff(oldMSTime), details);
+    else
+        ALE_LOG_INFO("[ALE]: Executed {} Lua scripts in {} ms {}", count, ALEUtil::GetTimeDiff(oldMSTime), details);
+
+    if (!boundMap)
+        scriptsLoaded = true;
 
     OnLuaStateOpen();
 }
 
+uint32 ALE::NewTypeId()
+{
+    return typeIdCounter++;
+}
+
+void ALE::SetMetatableRef(uint32 typeId, int ref)
+{
+    if (typeId >= metatableRefs.size())
+        metatableRefs.resize(typeId + 1, LUA_NOREF);
+    metatableRefs[typeId] = ref;
+}
+
 void ALE::InvalidateObjects()
 {
     ++callstackid;
@@ -837,7 +1381,7 @@ int ALE::StackTrace(lua_State *_L)
 
     // dirty stack?
     // Stack: errmsg, debug, tracemsg
-    sALE->OnError(std::string(lua_tostring(_L, -1)));
+    GetALE(_L)->OnError(std::string(lua_tostring(_L, -1)));
     return 1;
 }
 
@@ -904,11 +1448,20 @@ void ALE::Push(lua_State* luastate)
 }
 void ALE::Push(lua_State* luastate, const long long l)
 {
+#ifdef ALE_NATIVE_INT64
+    lua_pushinteger(luastate, static_cast<lua_Integer>(l));
+#else
     ALETemplate<long long>::Push(luastate, new long long(l));
+#endif
 }
 void ALE::Push(lua_State* luastate, const unsigned long long l)
 {
+#ifdef ALE_NATIVE_INT64
+    // Values above INT64_MAX wrap to negative integers, the same as Lua's own unsigned handling
+    lua_pushinteger(luastate, static_cast<lua_Integer>(l));
+#else
     ALETemplate<unsigned long long>::Push(luastate, new unsigned long long(l));
+#endif
 }
 void ALE::Push(lua_State* luastate, const long l)
 {
@@ -1023,9 +1576,14 @@ void ALE::Push(lua_State* luastate, Object const* obj)
             ALETemplate<Object>::Push(luastate, obj);
     }
 }
+void ALE::PushView(WorldPacket const& packet)
+{
+    ALETemplate<WorldPacket>::PushView(L, &packet, packet.rpos());
+    ++push_counter;
+}
 void ALE::Push(lua_State* luastate, ObjectGuid const guid)
 {
-    ALETemplate<unsigned long long>::Push(luastate, new unsigned long long(guid.GetRawValue()));
+    Push(luastate, static_cast<unsigned long long>(guid.GetRawValue()));
 }
 
 void ALE::Push(lua_State* luastate, GemPropertiesEntry const& gemProperties)
@@ -1168,12 +1726,20 @@ template<> std::string ALE::CHECKVAL<std::string>(lua_State* luastate, int narg)
 }
 template<> long long ALE::CHECKVAL<long long>(lua_State* luastate, int narg)
 {
+#ifdef ALE_NATIVE_INT64
+    if (lua_isinteger(luastate, narg))
+        return static_cast<long long>(lua_tointeger(luastate, narg));
+#endif
     if (lua_isnumber(luastate, narg))
         return static_cast<long long>(CHECKVAL<double>(luastate, narg));
     return *(ALE::CHECKOBJ<long long>(luastate, narg, true));
 }
 template<> unsigned long long ALE::CHECKVAL<unsigned long long>(lua_State* luastate, int narg)
 {
+#ifdef ALE_NATIVE_INT64
+    if (lua_isinteger(luastate, narg))
+        return static_cast<unsigned long long>(lua_tointeger(luastate, narg));
+#endif
     if (lua_isnumber(luastate, narg))
         return static_cast<unsigned long long>(CHECKVAL<uint32>(luastate, narg));
     return *(ALE::CHECKOBJ<unsigned long long>(luastate, narg, true));
@@ -1191,34 +1757,68 @@ template<> ObjectGuid ALE::CHECKVAL<ObjectGuid>(lua_State* luastate, int narg)
     return ObjectGuid(uint64((CHECKVAL<unsigned long long>(luastate, narg))));
 }
 
+/*
+ * Returns the ALEObject at `narg`, or NULL if the value is not an ALE object.
+ *
+ * The metatable is checked for the ALE marker first, so other userdata (e.g. io.stdout)
+ *   and lightuserdata are never read as an ALEObject.
+ */
+static ALEObject* ToALEObject(lua_State* luastate, int narg)
+{
+    if (lua_type(luastate, narg) != LUA_TUSERDATA)
+        return NULL;
+
+    // The metatable is pushed on top, relative indexes have to be made absolute first
+    if (narg < 0 && narg > LUA_REGISTRYINDEX)
+        narg = lua_gettop(luastate) + narg + 1;
+
+    if (!lua_getmetatable(luastate, narg))
+        return NULL;
+
+    lua_rawgeti(luastate, -1, ALEObject::METATABLE_MARKER_KEY);
+    bool isObject = lua_touserdata(luastate, -1) == ALEObject::GetMetatableMarker();
+    lua_pop(luastate, 2);
+    return isObject ? static_cast<ALEObject*>(lua_touserdata(luastate, narg)) : NULL;
+}
+
+/*
+ * The type mask of the object tells which derived class was pushed, so only
+ *   that class is checked. The derived pointer is then converted to the base class.
+ */
+static uint32 GetTypeMask(lua_State* luastate, int narg)
+{
+    ALEObject* obj = ToALEObject(luastate, narg);
+    return obj ? obj->GetTypeMask() : 0;
+}
+
 template<> Object* ALE::CHECKOBJ<Object>(lua_State* luastate, int narg, bool error)
 {
-    Object* obj = CHECKOBJ<WorldObject>(luastate, narg, false);
-    if (!obj)
-        obj = CHECKOBJ<Item>(luastate, narg, false);
-    if (!obj)
-        obj = ALETemplate<Object>::Check(luastate, narg, error);
-    return obj;
+    uint32 mask = GetTypeMask(luastate, narg);
+    if (mask & ALE_TYPEMASK_WORLDOBJECT)
+        return CHECKOBJ<WorldObject>(luastate, narg, error);
+    if (mask & ALE_TYPEMASK_ITEM)
+        return CHECKOBJ<Item>(luastate, narg, error);
+    return ALETemplate<Object>::Check(luastate, narg, error);
 }
 template<> WorldObject* ALE::CHECKOBJ<WorldObject>(lua_State* luastate, int narg, bool error)
 {
-    WorldObject* obj = CHECKOBJ<Unit>(luastate, narg, false);
-    if (!obj)
-        obj = CHECKOBJ<GameObject>(luastate, narg, false);
-    if (!obj)
-        obj = CHECKOBJ<Corpse>(luastate, narg, false);
-    if (!obj)
-        obj = ALETemplate<WorldObject>::Check(luastate, narg, error);
-    return obj;
+    uint32 mask = GetTypeMask(luastate, narg);
+    if (mask & ALE_TYPEMASK_UNIT)
+        return CHECKOBJ<Unit>(luastate, narg, error);
+    if (mask & ALE_TYPEMASK_GAMEOBJECT)
+        return CHECKOBJ<GameObject>(luastate, narg, error);
+    if (mask & ALE_TYPEMASK_CORPSE)
+        return CHECKOBJ<Corpse>(luastate, narg, error);
+    return ALETemplate<WorldObject>::Check(luastate, narg, error);
 }
 template<> Unit* ALE::CHECKOBJ<Unit>(lua_State* luastate, int narg, bool error)
 {
-    Unit* obj = CHECKOBJ<Player>(luastate, narg, false);
-    if (!obj)
-        obj = CHECKOBJ<Creature>(luastate, narg, false);
-    if (!obj)
-        obj = ALETemplate<Unit>::Check(luastate, narg, error);
-    return obj;
+    uint32 mask = GetTypeMask(luastate, narg);
+    if (mask & ALE_TYPEMASK_PLAYER)
+        return CHECKOBJ<Player>(luastate, narg, error);
+    if (mask & ALE_TYPEMASK_CREATURE)
+        return CHECKOBJ<Creature>(luastate, narg, error);
+    return ALETemplate<Unit>::Check(luastate, narg, error);
 }
 
 template<> ALEObject* ALE::CHECKOBJ<ALEObject>(lua_State* luastate, int narg, bool error)
@@ -1235,19 +1835,20 @@ ALEObject* ALE::CHECKTYPE(lua_State* luastate, int narg, const char* tname, bool
         return NULL;
     }
 
-    ALEObject** ptrHold = static_cast<ALEObject**>(lua_touserdata(luastate, narg));
+    // ALEObjects are stored inline in the userdata
+    ALEObject* obj = ToALEObject(luastate, narg);
 
-    if (!ptrHold || (tname && (*ptrHold)->GetTypeName() != tname))
+    if (!obj || (tname && obj->GetTypeName() != tname))
     {
         if (error)
         {
             char buff[256];
-            snprintf(buff, 256, "bad argument : %s expected, got %s", tname ? tname : "ALEObject", ptrHold ? (*ptrHold)->GetTypeName() : luaL_typename(luastate, narg));
+            snprintf(buff, 256, "bad argument : %s expected, got %s", tname ? tname : "ALEObject", obj ? obj->GetTypeName() : luaL_typename(luastate, narg));
             luaL_argerror(luastate, narg, buff);
         }
         return NULL;
     }
-    return *ptrHold;
+    return obj;
 }
 
 template<typename K>
@@ -1274,18 +1875,123 @@ static void createCancelCallback(lua_State* L, uint64 bindingID, BindingMap<K>*
     // Stack: cancel_callback
 }
 
+// Update hooks are the only ones called often enough for a binding interval to make sense
+static bool IsUpdateEvent(uint8 regtype, uint32 event_id)
+{
+    switch (regtype)
+    {
+        case Hooks::REGTYPE_SERVER:
+            return event_id == Hooks::MAP_EVENT_ON_UPDATE;
+        case Hooks::REGTYPE_CREATURE:
+            return event_id == Hooks::CREATURE_EVENT_ON_AIUPDATE;
+        case Hooks::REGTYPE_GAMEOBJECT:
+            return event_id == Hooks::GAMEOBJECT_EVENT_ON_AIUPDATE;
+        case Hooks::REGTYPE_MAP:
+        case Hooks::REGTYPE_INSTANCE:
+            return event_id == Hooks::INSTANCE_EVENT_ON_UPDATE;
+        default:
+            return false;
+    }
+}
+
+// Mask of the binding filter fields the hook of an event sets, 0 if it does not support filters
+static uint32 GetFilterFields(uint8 regtype, uint32 event_id)
+{
+    if (regtype != Hooks::REGTYPE_PLAYER)
+        return 0;
+
+    const uint32 playerFields = (1 << FILTER_MAP_ID) | (1 << FILTER_ZONE_ID) | (1 << FILTER_CLASS);
+    switch (event_id)
+    {
+        case Hooks::PLAYER_EVENT_ON_SPELL_CAST:
+            return playerFields | (1 << FILTER_SPELL_ID);
+        case Hooks::PLAYER_EVENT_ON_DAMAGE:
+            return playerFields | (1 << FILTER_ENTRY);
+        case Hooks::PLAYER_EVENT_ON_UPDATE_ZONE:
+            return playerFields;
+        case Hooks::PLAYER_EVENT_ON_CHAT:
+        case Hooks::PLAYER_EVENT_ON_WHISPER:
+        case Hooks::PLAYER_EVENT_ON_GROUP_CHAT:
+        case Hooks::PLAYER_EVENT_ON_GUILD_CHAT:
+        case Hooks::PLAYER_EVENT_ON_CHANNEL_CHAT:
+            return playerFields | (1 << FILTER_CHAT_TYPE);
+        default:
+            return 0;
+    }
+}
+
+// Mask of the fields of a filter table checked by `CheckBindingFilter` of the global methods
+static uint32 GetBindingFilterFields(lua_State* L, int narg)
+{
+    uint32 fields = 0;
+    lua_pushnil(L);
+    while (lua_next(L, narg))
+    {
+        BindingFilterField field;
+        if (GetBindingFilterField(lua_tostring(L, -2), field))
+            fields |= 1 << field;
+        lua_pop(L, 1);
+    }
+    return fields;
+}
+
+// Reads a filter table checked by `CheckBindingFilter` of the global methods, nullptr without one or for an empty one
+static std::shared_ptr<const BindingFilter> ReadBindingFilter(lua_State* L, int narg)
+{
+    if (!narg || !GetBindingFilterFields(L, narg))
+        return nullptr;
+
+    std::shared_ptr<BindingFilter> filter = std::make_shared<BindingFilter>();
+    lua_pushnil(L);
+    while (lua_next(L, narg))
+    {
+        // Stack: key, value
+        BindingFilterField field;
+        GetBindingFilterField(lua_tostring(L, -2), field);
+        if (lua_istable(L, -1))
+        {
+            int count = static_cast<int>(lua_rawlen(L, -1));
+            for (int i = 1; i <= count; ++i)
+            {
+                lua_rawgeti(L, -1, i);
+                filter->Add(field, static_cast<uint32>(lua_tointeger(L, -1)));
+                lua_pop(L, 1);
+            }
+        }
+        else
+            filter->Add(field, static_cast<uint32>(lua_tointeger(L, -1)));
+        lua_pop(L, 1);
+        // Stack: key
+    }
+    return filter;
+}
+
 // Saves the function reference ID given to the register type's store for given entry under the given event
-int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, uint32 instanceId, uint32 event_id, int functionRef, uint32 shots)
+int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, uint32 instanceId, uint32 event_id, int functionRef, uint32 shots, uint32 interval, int filterIndex)
 {
     uint64 bindingID;
 
+    if (interval && !IsUpdateEvent(regtype, event_id))
+    {
+        luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
+        luaL_error(L, "Interval is only supported by update events (regtype %d, event %d)", static_cast<int>(regtype), static_cast<int>(event_id));
+        return 0; // Stack: (empty)
+    }
+
+    if (filterIndex && (GetBindingFilterFields(L, filterIndex) & ~GetFilterFields(regtype, event_id)))
+    {
+        luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
+        luaL_error(L, "Filter has fields the event does not support (regtype %d, event %d)", static_cast<int>(regtype), static_cast<int>(event_id));
+        return 0; // Stack: (empty)
+    }
+
     switch (regtype)
     {
         case Hooks::REGTYPE_SERVER:
             if (event_id < Hooks::SERVER_EVENT_COUNT)
             {
                 auto key = EventKey<Hooks::ServerEvents>((Hooks::ServerEvents)event_id);
-                bindingID = ServerEventBindings->Insert(key, functionRef, shots);
+                bindingID = ServerEventBindings->Insert(key, functionRef, shots, interval);
                 createCancelCallback(L, bindingID, ServerEventBindings);
                 return 1; // Stack: callback
             }
@@ -1295,7 +2001,7 @@ int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, ui
             if (event_id < Hooks::PLAYER_EVENT_COUNT)
             {
                 auto key = EventKey<Hooks::PlayerEvents>((Hooks::PlayerEvents)event_id);
-                bindingID = PlayerEventBindings->Insert(key, functionRef, shots);
+                bindingID = PlayerEventBindings->Insert(key, functionRef, shots, interval, ReadBindingFilter(L, filterIndex));
                 createCancelCallback(L, bindingID, PlayerEventBindings);
                 return 1; // Stack: callback
             }
@@ -1371,7 +2077,7 @@ int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, ui
                     }
 
                     auto key = EntryKey<Hooks::CreatureEvents>((Hooks::CreatureEvents)event_id, entry);
-                    bindingID = CreatureEventBindings->Insert(key, functionRef, shots);
+                    bindingID = CreatureEventBindings->Insert(key, functionRef, shots, interval);
                     createCancelCallback(L, bindingID, CreatureEventBindings);
                 }
                 else
@@ -1384,7 +2090,7 @@ int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, ui
                     }
 
                     auto key = UniqueObjectKey<Hooks::CreatureEvents>((Hooks::CreatureEvents)event_id, guid, instanceId);
-                    bindingID = CreatureUniqueBindings->Insert(key, functionRef, shots);
+                    bindingID = CreatureUniqueBindings->Insert(key, functionRef, shots, interval);
                     createCancelCallback(L, bindingID, CreatureUniqueBindings);
                 }
                 return 1; // Stack: callback
@@ -1419,7 +2125,7 @@ int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, ui
                 }
 
                 auto key = EntryKey<Hooks::GameObjectEvents>((Hooks::GameObjectEvents)event_id, entry);
-                bindingID = GameObjectEventBindings->Insert(key, functionRef, shots);
+                bindingID = GameObjectEventBindings->Insert(key, functionRef, shots, interval);
                 createCancelCallback(L, bindingID, GameObjectEventBindings);
                 return 1; // Stack: callback
             }
@@ -1490,7 +2196,7 @@ int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, ui
             if (event_id < Hooks::INSTANCE_EVENT_COUNT)
             {
                 auto key = EntryKey<Hooks::InstanceEvents>((Hooks::InstanceEvents)event_id, entry);
-                bindingID = MapEventBindings->Insert(key, functionRef, shots);
+                bindingID = MapEventBindings->Insert(key, functionRef, shots, interval);
                 createCancelCallback(L, bindingID, MapEventBindings);
                 return 1; // Stack: callback
             }
@@ -1500,7 +2206,7 @@ int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, ui
             if (event_id < Hooks::INSTANCE_EVENT_COUNT)
             {
                 auto key = EntryKey<Hooks::InstanceEvents>((Hooks::InstanceEvents)event_id, entry);
-                bindingID = InstanceEventBindings->Insert(key, functionRef, shots);
+                bindingID = InstanceEventBindings->Insert(key, functionRef, shots, interval);
                 createCancelCallback(L, bindingID, InstanceEventBindings);
                 return 1; // Stack: callback
             }
@@ -1550,6 +2256,162 @@ int ALE::Register(lua_State* L, uint8 regtype, uint32 entry, ObjectGuid guid, ui
     return 0;
 }
 
+// Reads entry `i` of a range table checked by `CheckEntryRanges` of the global methods, single entries give min == max
+static void GetEntryRange(lua_State* L, int narg, int i, uint32& min, uint32& max)
+{
+    lua_rawgeti(L, narg, i);
+    if (lua_istable(L, -1))
+    {
+        lua_rawgeti(L, -1, 1);
+        lua_rawgeti(L, -2, 2);
+        min = static_cast<uint32>(lua_tointeger(L, -2));
+        max = static_cast<uint32>(lua_tointeger(L, -1));
+        lua_pop(L, 2);
+    }
+    else
+        min = max = static_cast<uint32>(lua_tointeger(L, -1));
+    lua_pop(L, 1);
+}
+
+template<typename K>
+static int InsertEntryRanges(lua_State* L, BindingMap<K>* bindings, const K& key, int rangesIndex, int functionRef, uint32 shots, uint32 interval)
+{
+    uint64 bindingID;
+    // Scoped so the list is gone before anything that can raise a Lua error
+    {
+        EntryRangeList ranges;
+        int count = static_cast<int>(lua_rawlen(L, rangesIndex));
+        for (int i = 1; i <= count; ++i)
+        {
+            uint32 min, max;
+            GetEntryRange(L, rangesIndex, i, min, max);
+            ranges.emplace_back(min, max);
+        }
+        bindingID = bindings->InsertRanges(key, std::move(ranges), functionRef, shots, interval);
+    }
+    createCancelCallback(L, bindingID, bindings);
+    return 1; // Stack: callback
+}
+
+// Checks a single entry given to `RegisterEntries` the same way `Register` does, ranges may have gaps and are not checked
+static bool IsValidEntry(uint8 regtype, uint32 entry, const char*& type)
+{
+    switch (regtype)
+    {
+        case Hooks::REGTYPE_CREATURE:
+        case Hooks::REGTYPE_CREATURE_GOSSIP:
+            type = "creature";
+            return eObjectMgr->GetCreatureTemplate(entry) != nullptr;
+        case Hooks::REGTYPE_GAMEOBJECT:
+        case Hooks::REGTYPE_GAMEOBJECT_GOSSIP:
+            type = "gameobject";
+            return eObjectMgr->GetGameObjectTemplate(entry) != nullptr;
+        case Hooks::REGTYPE_ITEM:
+        case Hooks::REGTYPE_ITEM_GOSSIP:
+            type = "item";
+            return eObjectMgr->GetItemTemplate(entry) != nullptr;
+        case Hooks::REGTYPE_SPELL:
+            type = "spell";
+            return sSpellMgr->GetSpellInfo(entry) != nullptr;
+        default:
+            return true;
+    }
+}
+
+// Saves one function reference ID for all entries in the range table at `rangesIndex` to the register type's store under the given event
+int ALE::RegisterEntries(lua_State* L, uint8 regtype, int rangesIndex, uint32 event_id, int functionRef, uint32 shots, uint32 interval)
+{
+    if (interval && !IsUpdateEvent(regtype, event_id))
+    {
+        luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
+        luaL_error(L, "Interval is only supported by update events (regtype %d, event %d)", static_cast<int>(regtype), static_cast<int>(event_id));
+        return 0; // Stack: (empty)
+    }
+
+    int count = static_cast<int>(lua_rawlen(L, rangesIndex));
+    for (int i = 1; i <= count; ++i)
+    {
+        uint32 min, max;
+        GetEntryRange(L, rangesIndex, i, min, max);
+
+        const char* type = "entry";
+        if (min == max && !IsValidEntry(regtype, min, type))
+        {
+            luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
+            luaL_error(L, "Couldn't find a %s with (ID: %d)!", type, min);
+            return 0; // Stack: (empty)
+        }
+
+        if (regtype == Hooks::REGTYPE_PACKET && max >= NUM_MSG_TYPES)
+        {
+            luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
+            luaL_error(L, "Couldn't find an opcode with (ID: %d)!", max);
+            return 0; // Stack: (empty)
+        }
+    }
+
+    switch (regtype)
+    {
+        case Hooks::REGTYPE_PACKET:
+            if (event_id < Hooks::PACKET_EVENT_COUNT)
+                return InsertEntryRanges(L, PacketEventBindings, EntryKey<Hooks::PacketEvents>((Hooks::PacketEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_CREATURE:
+            if (event_id < Hooks::CREATURE_EVENT_COUNT)
+                return InsertEntryRanges(L, CreatureEventBindings, EntryKey<Hooks::CreatureEvents>((Hooks::CreatureEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_CREATURE_GOSSIP:
+            if (event_id < Hooks::GOSSIP_EVENT_COUNT)
+                return InsertEntryRanges(L, CreatureGossipBindings, EntryKey<Hooks::GossipEvents>((Hooks::GossipEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_GAMEOBJECT:
+            if (event_id < Hooks::GAMEOBJECT_EVENT_COUNT)
+                return InsertEntryRanges(L, GameObjectEventBindings, EntryKey<Hooks::GameObjectEvents>((Hooks::GameObjectEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_GAMEOBJECT_GOSSIP:
+            if (event_id < Hooks::GOSSIP_EVENT_COUNT)
+                return InsertEntryRanges(L, GameObjectGossipBindings, EntryKey<Hooks::GossipEvents>((Hooks::GossipEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_ITEM:
+            if (event_id < Hooks::ITEM_EVENT_COUNT)
+                return InsertEntryRanges(L, ItemEventBindings, EntryKey<Hooks::ItemEvents>((Hooks::ItemEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_ITEM_GOSSIP:
+            if (event_id < Hooks::GOSSIP_EVENT_COUNT)
+                return InsertEntryRanges(L, ItemGossipBindings, EntryKey<Hooks::GossipEvents>((Hooks::GossipEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_PLAYER_GOSSIP:
+            if (event_id < Hooks::GOSSIP_EVENT_COUNT)
+                return InsertEntryRanges(L, PlayerGossipBindings, EntryKey<Hooks::GossipEvents>((Hooks::GossipEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_MAP:
+            if (event_id < Hooks::INSTANCE_EVENT_COUNT)
+                return InsertEntryRanges(L, MapEventBindings, EntryKey<Hooks::InstanceEvents>((Hooks::InstanceEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_INSTANCE:
+            if (event_id < Hooks::INSTANCE_EVENT_COUNT)
+                return InsertEntryRanges(L, InstanceEventBindings, EntryKey<Hooks::InstanceEvents>((Hooks::InstanceEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+
+        case Hooks::REGTYPE_SPELL:
+            if (event_id < Hooks::SPELL_EVENT_COUNT)
+                return InsertEntryRanges(L, SpellEventBindings, EntryKey<Hooks::SpellEvents>((Hooks::SpellEvents)event_id, 0), rangesIndex, functionRef, shots, interval);
+            break;
+    }
+    luaL_unref(L, LUA_REGISTRYINDEX, functionRef);
+    luaL_error(L, "Unknown event type (regtype %d, event %d)", static_cast<int>(regtype), static_cast<int>(event_id));
+    return 0;
+}
+
 /*
  * Cleans up the stack, effectively undoing all Push calls and the Setup call.
  */
@@ -1599,17 +2461,13 @@ CreatureAI* ALE::GetAI(Creature* creature)
     if (!ALEConfig::GetInstance().IsALEEnabled())
         return NULL;
 
-    for (int i = 1; i < Hooks::CREATURE_EVENT_COUNT; ++i)
-    {
-        Hooks::CreatureEvents event_id = (Hooks::CreatureEvents)i;
+    // The event ID is ignored, any creature event makes the creature use the ALE AI
+    auto entryKey = EntryKey<Hooks::CreatureEvents>(Hooks::CREATURE_EVENT_COUNT, creature->GetEntry());
+    auto uniqueKey = UniqueObjectKey<Hooks::CreatureEvents>(Hooks::CREATURE_EVENT_COUNT, creature->GET_GUID(), creature->GetInstanceId());
 
-        auto entryKey = EntryKey<Hooks::CreatureEvents>(event_id, creature->GetEntry());
-        auto uniqueKey = UniqueObjectKey<Hooks::CreatureEvents>(event_id, creature->GET_GUID(), creature->GetInstanceId());
-
-        if (CreatureEventBindings->HasBindingsFor(entryKey) ||
-            CreatureUniqueBindings->HasBindingsFor(uniqueKey))
-            return new ALECreatureAI(creature);
-    }
+    if (CreatureEventBindings->HasBindingsForObject(entryKey) ||
+        CreatureUniqueBindings->HasBindingsForObject(uniqueKey))
+        return new ALECreatureAI(creature, this);
 
     return NULL;
 }
@@ -1619,16 +2477,13 @@ InstanceData* ALE::GetInstanceData(Map* map)
     if (!ALEConfig::GetInstance().IsALEEnabled())
         return NULL;
 
-    for (int i = 1; i < Hooks::INSTANCE_EVENT_COUNT; ++i)
-    {
-        Hooks::InstanceEvents event_id = (Hooks::InstanceEvents)i;
+    // The event ID is ignored, any map or instance event makes the map use the ALE instance data
+    auto mapKey = EntryKey<Hooks::InstanceEvents>(Hooks::INSTANCE_EVENT_COUNT, map->GetId());
+    auto instanceKey = EntryKey<Hooks::InstanceEvents>(Hooks::INSTANCE_EVENT_COUNT, map->GetInstanceId());
 
-        auto key = EntryKey<Hooks::InstanceEvents>(event_id, map->GetId());
-
-        if (MapEventBindings->HasBindingsFor(key) ||
-            InstanceEventBindings->HasBindingsFor(key))
-            return new ALEInstanceAI(map);
-    }
+    if (MapEventBindings->HasBindingsForObject(mapKey) ||
+        InstanceEventBindings->HasBindingsForObject(instanceKey))
+        return new ALEInstanceAI(map, this);
 
     return NULL;
 }
@@ -1680,7 +2535,7 @@ void ALE::CreateInstanceData(Map const* map)
  */
 void ALE::FreeInstanceId(uint32 instanceId)
 {
-    LOCK_ALE;
+    LOCK_ALE_STATE;
 
     if (!ALEConfig::GetInstance().IsALEEnabled())
         return;
@@ -21,20 +21,28 @@
 #include "LFG.h"
 #include "ALEUtility.h"
 #include "HttpManager.h"
+#include "ALECoroutineScheduler.h"
+#include "BindingMap.h"
 #include "EventEmitter.h"
 #include "TicketMgr.h"
 #include "LootMgr.h"
 #include "ALEFileWatcher.h"
+#include "ALEScriptArchive.h"
 #include "ALEConfig.h"
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
 #include <memory>
 #include <vector>
 #include <ctime>
 #include <unordered_map>
+#include <unordered_set>
+#include <set>
 
 extern "C"
 {
 #include <lua.h>
+#include <lauxlib.h>
 };
 
 struct ItemTemplate;
@@ -99,11 +107,15 @@ struct LuaScript
     std::string filename;
     std::string filepath;
     std::string modulepath;
-    LuaScript() {}
+    // Set for scripts packed in the script archive
+    const ALEScriptArchive::Entry* archiveEntry;
+    LuaScript() : archiveEntry(nullptr) {}
 };
 
 #define ALE_STATE_PTR "ALE State Ptr"
 #define LOCK_ALE ALE::Guard __guard(ALE::GetLock())
+// Locks the state the calling member function belongs to, see ALE::GetStateLock
+#define LOCK_ALE_STATE ALE::Guard __guard(GetStateLock())
 
 #define ALE_GAME_API AC_GAME_API
 
@@ -111,6 +123,8 @@ class ALE_GAME_API ALE
 {
 public:
     typedef std::list<LuaScript> ScriptList;
+    // Module name -> script path, see ALE::BuildModuleIndex
+    typedef std::unordered_map<std::string, std::string> ModuleIndex;
 
     typedef std::recursive_mutex LockType;
     typedef std::lock_guard<LockType> Guard;
@@ -119,10 +133,32 @@ public:
     const std::string& GetRequireCPath() const { return lua_requirecpath; }
 
 private:
+    friend class ALECoroutineScheduler;
+
     static bool reload;
+    // Set while every pending reload came with the files it changed, see ReloadALE
+    static bool reloadChangesKnown;
+    static std::set<std::string> reloadChangedFiles;
     static bool initialized;
+    static bool multiState;
+    static bool scriptsLoaded;
     static LockType lock;
     static std::unique_ptr<ALEFileWatcher> fileWatcher;
+    static std::shared_ptr<ALEScriptArchive> scriptArchive;
+    static std::shared_ptr<const ModuleIndex> moduleIndex;
+
+    // Map -> per map state, only used when ALE.MultiState is enabled
+    static std::unordered_map<Map const*, ALE*> mapStates;
+    static std::shared_mutex mapStatesLock;
+
+    // Points to this state, gives the event processors of map states a stable ALE**
+    ALE* self;
+    // The map this state belongs to, NULL for the world state
+    Map* boundMap;
+    // Lock used by map states, the world state uses the global lock
+    LockType stateLock;
+    // Set on map states that need to (re)load their scripts on their next map update
+    std::atomic<bool> reloadPending;
 
     // Lua script locations
     static ScriptList lua_scripts;
@@ -133,6 +169,8 @@ private:
     // lua path variable for require() function
     static std::string lua_requirepath;
     static std::string lua_requirecpath;
+    // On-disk bytecode cache folder, empty if disabled
+    static std::string lua_bytecodepath;
 
     // A counter for lua event stacks that occur (see event_level).
     // This is used to determine whether an object belongs to the current call stack or not.
@@ -146,13 +184,26 @@ private:
     // When a hook pushes arguments to be passed to event handlers,
     //  this is used to keep track of how many arguments were pushed.
     uint8 push_counter;
+    // Registry ref of a weak valued table: object pointer -> userdata pushed during the current call stack
+    int objectCacheRef;
+    // The script archive and module index this state was opened with, used by its require searcher
+    std::shared_ptr<ALEScriptArchive> archive;
+    std::shared_ptr<const ModuleIndex> modules;
+    // Registry refs of the class metatables, indexed by ALETemplate type id
+    std::vector<int> metatableRefs;
 
     // Map from instance ID -> Lua table ref
     std::unordered_map<uint32, int> instanceDataRefs;
     // Map from map ID -> Lua table ref
     std::unordered_map<uint32, int> continentDataRefs;
 
-    ALE();
+    // Timers of update handlers registered with an interval, for hooks without an AI to keep them
+    std::unordered_map<GameObject const*, ALEUpdateTimers> gameObjectUpdateTimers;
+    // Set once a gameobject update handler ran, removing gameobjects doesn't lock the state before that
+    std::atomic<bool> hasGameObjectUpdateTimers;
+    std::unordered_map<Map const*, ALEUpdateTimers> mapUpdateTimers;
+
+    ALE(Map* map = NULL);
     ~ALE();
 
     // Prevent copy
@@ -168,20 +219,31 @@ private:
     // Use ReloadALE() to make ALE reload
     // This is called on world update to reload ALE
     static void _ReloadALE();
+    // Reloads a map state, called from its own map update
+    void ReloadMapState();
     static void LoadScriptPaths();
     static void GetScripts(std::string path);
-    static void AddScriptPath(std::string filename, const std::string& fullpath);
+    static void AddScriptPath(std::string filename, const std::string& fullpath, const ALEScriptArchive::Entry* archiveEntry = nullptr);
+    static void AddArchiveScripts(const std::string& archivePath);
+    static void BuildModuleIndex();
+    static int ModuleSearcher(lua_State* L);
     static int LoadCompiledScript(lua_State* L, const std::string& filepath);
     static std::time_t GetFileModTime(const std::string& filepath);
     static std::time_t GetFileModTimeWithCache(const std::string& filepath);
     
     // Global cache management
+    static bool CompileToBytecode(lua_State* tempL, const std::string& filepath, bool isMoonScript, BytecodeBuffer& bytecode);
+    static bool BuildBytecode(lua_State*& tempL, const std::string& filepath, bool isMoonScript, BytecodeBuffer& bytecode);
+    static bool CompileToGlobalCache(const std::string& filepath, bool isMoonScript);
+    static void StoreInGlobalCache(const std::string& filepath, std::time_t modTime, BytecodeBuffer&& bytecode);
     static bool CompileScriptToGlobalCache(const std::string& filepath);
     static bool CompileMoonScriptToGlobalCache(const std::string& filepath);
+    static void PrecompileScripts(const ScriptList& scripts, std::unordered_set<std::string>& compiled);
     static int TryLoadFromGlobalCache(lua_State* L, const std::string& filepath);
     static int LoadScriptWithCache(lua_State* L, const std::string& filepath, bool isMoonScript, uint32* compiledCount = nullptr, uint32* cachedCount = nullptr);
     static void ClearGlobalCache();
     static void ClearTimestampCache();
+    static void ClearTimestampCache(const std::set<std::string>& filepaths);
     static size_t GetGlobalCacheSize();
 
     static int StackTrace(lua_State *_L);
@@ -189,26 +251,31 @@ private:
 
     // Some helpers for hooks to call event handlers.
     // The bodies of the templates are in HookHelpers.h, so if you want to use them you need to #include "HookHelpers.h".
-    template<typename K1, typename K2> int SetupStack(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, int number_of_arguments);
+    template<typename K1, typename K2> int SetupStack(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, int number_of_arguments, uint32 interval = BINDING_INTERVAL_ANY, const BindingFilterContext* filterContext = nullptr);
                                        int CallOneFunction(int number_of_functions, int number_of_arguments, int number_of_results);
                                        void CleanUpStack(int number_of_arguments);
     template<typename T>               void ReplaceArgument(T value, uint8 index);
-    template<typename K1, typename K2> void CallAllFunctions(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2);
-    template<typename K1, typename K2> bool CallAllFunctionsBool(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, bool default_value = false);
+    template<typename K1, typename K2> void CallAllFunctions(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, const BindingFilterContext* filterContext = nullptr);
+    template<typename K1, typename K2> bool CallAllFunctionsBool(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, bool default_value = false, uint32 interval = BINDING_INTERVAL_ANY, const BindingFilterContext* filterContext = nullptr);
+    template<typename K1, typename K2, typename F> bool CallUpdateFunctions(BindingMap<K1>* bindings1, BindingMap<K2>* bindings2, const K1& key1, const K2& key2, ALEUpdateTimers& timers, uint32 diff, F push_arguments);
 
     // Same as above but for only one binding instead of two.
     // `key` is passed twice because there's no NULL for references, but it's not actually used if `bindings2` is NULL.
-    template<typename K> int SetupStack(BindingMap<K>* bindings, const K& key, int number_of_arguments)
+    template<typename K> int SetupStack(BindingMap<K>* bindings, const K& key, int number_of_arguments, const BindingFilterContext* filterContext = nullptr)
+    {
+        return SetupStack<K, K>(bindings, NULL, key, key, number_of_arguments, BINDING_INTERVAL_ANY, filterContext);
+    }
+    template<typename K> void CallAllFunctions(BindingMap<K>* bindings, const K& key, const BindingFilterContext* filterContext = nullptr)
     {
-        return SetupStack<K, K>(bindings, NULL, key, key, number_of_arguments);
+        CallAllFunctions<K, K>(bindings, NULL, key, key, filterContext);
     }
-    template<typename K> void CallAllFunctions(BindingMap<K>* bindings, const K& key)
+    template<typename K> bool CallAllFunctionsBool(BindingMap<K>* bindings, const K& key, bool default_value = false, const BindingFilterContext* filterContext = nullptr)
     {
-        CallAllFunctions<K, K>(bindings, NULL, key, key);
+        return CallAllFunctionsBool<K, K>(bindings, NULL, key, key, default_value, BINDING_INTERVAL_ANY, filterContext);
     }
-    template<typename K> bool CallAllFunctionsBool(BindingMap<K>* bindings, const K& key, bool default_value = false)
+    template<typename K, typename F> bool CallUpdateFunctions(BindingMap<K>* bindings, const K& key, ALEUpdateTimers& timers, uint32 diff, F push_arguments)
     {
-        return CallAllFunctionsBool<K, K>(bindings, NULL, key, key, default_value);
+        return CallUpdateFunctions<K, K, F>(bindings, NULL, key, key, timers, diff, push_arguments);
     }
 
     // Non-static pushes, to be used in hooks.
@@ -229,6 +296,8 @@ private:
     void Push(const CreatureTemplate* value)    { Push(L, value); ++push_counter; }
     template<typename T>
     void Push(T const* ptr)                     { Push(L, ptr); ++push_counter; }
+    // Pushes a read only view of the packet, it is only copied if a script modifies or keeps it
+    void PushView(WorldPacket const& packet);
 
 public:
     static ALE* GALE;
@@ -236,6 +305,7 @@ public:
     lua_State* L;
     EventMgr* eventMgr;
     HttpManager httpManager;
+    ALECoroutineScheduler coroutineScheduler;
     QueryCallbackProcessor queryProcessor;
     EventEmitter<void(std::string)> OnError;
 
@@ -265,9 +335,23 @@ public:
     static void Initialize();
     static void Uninitialize();
     // This function is used to make ALE reload
-    static void ReloadALE() { LOCK_ALE; reload = true; }
+    static void ReloadALE() { LOCK_ALE; reload = true; reloadChangesKnown = false; }
+    // Makes ALE reload when only the given script files changed, unchanged scripts skip their timestamp check
+    static void ReloadALE(const std::set<std::string>& changedFiles);
     static LockType& GetLock() { return lock; };
     static bool IsInitialized() { return initialized; }
+    static bool IsMultiStateEnabled() { return multiState; }
+
+    // Returns the state handling hooks for `map`, the world state if multistate is disabled or the map has no state
+    static ALE* GetStateFor(Map const* map);
+    // Same as GetStateFor but returns a pointer that stays valid as long as the state exists, for event processors
+    static ALE** GetStatePtrFor(Map const* map);
+    static void CreateMapState(Map* map);
+    static void DestroyMapState(Map* map);
+
+    // Map states are locked separately so that maps can update their states in parallel
+    LockType& GetStateLock() { return boundMap ? stateLock : lock; }
+    Map* GetBoundMap() const { return boundMap; }
     // Never returns nullptr
     static ALE* GetALE(lua_State* L)
     {
@@ -340,7 +424,13 @@ public:
     bool ShouldReload() const { return reload; }
     bool HasLuaState() const { return L != NULL; }
     uint64 GetCallstackId() const { return callstackid; }
-    int Register(lua_State* L, uint8 reg, uint32 entry, ObjectGuid guid, uint32 instanceId, uint32 event_id, int functionRef, uint32 shots);
+    int GetObjectCacheRef() const { return objectCacheRef; }
+    int GetMetatableRef(uint32 typeId) const { return typeId < metatableRefs.size() ? metatableRefs[typeId] : LUA_NOREF; }
+    void SetMetatableRef(uint32 typeId, int ref);
+    // Returns a new process wide id for a class registered with ALETemplate
+    static uint32 NewTypeId();
+    int Register(lua_State* L, uint8 reg, uint32 entry, ObjectGuid guid, uint32 instanceId, uint32 event_id, int functionRef, uint32 shots, uint32 interval = 0, int filterIndex = 0);
+    int RegisterEntries(lua_State* L, uint8 reg, int rangesIndex, uint32 event_id, int functionRef, uint32 shots, uint32 interval = 0);
 
     // Checks
     template<typename T> static T CHECKVAL(lua_State* luastate, int narg);
@@ -400,7 +490,7 @@ public:
     void GetDialogStatus(const Player* pPlayer, const Creature* pCreature);
 
     bool OnSummoned(Creature* creature, Unit* summoner);
-    bool UpdateAI(Creature* me, const uint32 diff);
+    bool UpdateAI(Creature* me, const uint32 diff, ALEUpdateTimers& timers);
     bool EnterCombat(Creature* me, Unit* target);
     bool DamageTaken(Creature* me, Unit* attacker, uint32& damage);
     bool JustDied(Creature* me, Unit* killer);
@@ -164,6 +164,9 @@ luaL_Reg GlobalMethods[] =
     { "CreateLuaEvent", &LuaGlobalFunctions::CreateLuaEvent },
     { "RemoveEventById", &LuaGlobalFunctions::RemoveEventById },
     { "RemoveEvents", &LuaGlobalFunctions::RemoveEvents },
+    { "StartCoroutine", &LuaGlobalFunctions::StartCoroutine },
+    { "Sleep", &LuaGlobalFunctions::Sleep },
+    { "WaitForEvent", &LuaGlobalFunctions::WaitForEvent },
     { "PerformIngameSpawn", &LuaGlobalFunctions::PerformIngameSpawn },
     { "CreatePacket", &LuaGlobalFunctions::CreatePacket },
     { "AddVendorItem", &LuaGlobalFunctions::AddVendorItem },
@@ -1800,6 +1803,38 @@ ALERegister<Loot> LootMethods[] =
     { NULL, NULL }
 };
 
+// Replaces a view of the core's packet with a copy owned by Lua that continues reading where the view was
+static void CopyPacketView(ALEObject* obj)
+{
+    WorldPacket* copy = new WorldPacket(*static_cast<WorldPacket*>(obj->GetObj()));
+    copy->rpos(obj->GetViewPosition());
+    obj->SetOwnedCopy(copy);
+}
+
+// Packets of packet hooks are read only views of the core's packet.
+// Readers use the view's own read position (see LuaPacket::PacketReader), copy them before a method changes the packet
+template<> void ALETemplate<WorldPacket>::PrepareCall(lua_State* L, ALERegister<WorldPacket>* method)
+{
+    if (LuaPacket::IsReadOnly(method->mfunc))
+        return;
+
+    ALEObject* obj = ALE::CHECKTYPE(L, 1, tname, false);
+    if (obj && obj->IsView() && obj->IsValid())
+        CopyPacketView(obj);
+}
+
+// Keeping a view past the call needs a copy, the viewed packet only lives during the hook
+template<> int ALETemplate<WorldPacket>::SetInvalidation(lua_State* L)
+{
+    ALEObject* ALEObj = ALE::CHECKOBJ<ALEObject>(L, 1);
+    bool invalidate = ALE::CHECKVAL<bool>(L, 2);
+
+    if (!invalidate && ALEObj->IsView() && ALEObj->IsValid())
+        CopyPacketView(ALEObj);
+    ALEObj->SetValidation(invalidate);
+    return 0;
+}
+
 // fix compile error about accessing vehicle destructor
 template<> int ALETemplate<Vehicle>::CollectGarbage(lua_State* L)
 {
@@ -1807,7 +1842,8 @@ template<> int ALETemplate<Vehicle>::CollectGarbage(lua_State* L)
 
     // Get object pointer (and check type, no error)
     ALEObject* obj = ALE::CHECKOBJ<ALEObject>(L, 1, false);
-    delete obj;
+    if (obj)
+        obj->~ALEObject();
     return 0;
 }
 
@@ -1861,6 +1897,7 @@ template<> int ALETemplate<long long>::ToString(lua_State* L)
 void RegisterFunctions(ALE* E)
 {
     ALEGlobal::SetMethods(E, GlobalMethods);
+    ALECoroutineScheduler::WrapWaitingFunctions(E->L);
 
     ALETemplate<Object>::Register(E, "Object");
     ALETemplate<Object>::SetMethods(E, ObjectMethods);
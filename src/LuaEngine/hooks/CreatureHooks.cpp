@@ -21,7 +21,7 @@ using namespace Hooks;
     if (!CreatureEventBindings->HasBindingsFor(entry_key))\
         if (!CreatureUniqueBindings->HasBindingsFor(unique_key))\
             return;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 #define START_HOOK_WITH_RETVAL(EVENT, CREATURE, RETVAL) \
     if (!ALEConfig::GetInstance().IsALEEnabled())\
@@ -31,7 +31,7 @@ using namespace Hooks;
     if (!CreatureEventBindings->HasBindingsFor(entry_key))\
         if (!CreatureUniqueBindings->HasBindingsFor(unique_key))\
             return RETVAL;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 void ALE::OnDummyEffect(WorldObject* pCaster, uint32 spellId, SpellEffIndex effIndex, Creature* pTarget)
 {
@@ -92,12 +92,13 @@ bool ALE::OnSummoned(Creature* pCreature, Unit* pSummoner)
     return CallAllFunctionsBool(CreatureEventBindings, CreatureUniqueBindings, entry_key, unique_key);
 }
 
-bool ALE::UpdateAI(Creature* me, const uint32 diff)
+bool ALE::UpdateAI(Creature* me, const uint32 diff, ALEUpdateTimers& timers)
 {
     START_HOOK_WITH_RETVAL(CREATURE_EVENT_ON_AIUPDATE, me, false);
-    Push(me);
-    Push(diff);
-    return CallAllFunctionsBool(CreatureEventBindings, CreatureUniqueBindings, entry_key, unique_key);
+    return CallUpdateFunctions(CreatureEventBindings, CreatureUniqueBindings, entry_key, unique_key, timers, diff, [&]()
+    {
+        Push(me);
+    });
 }
 
 //Called for reaction at enter to combat if not in combat yet (enemy can be NULL)
@@ -20,7 +20,7 @@ using namespace Hooks;
     auto key = EntryKey<GameObjectEvents>(EVENT, ENTRY);\
     if (!GameObjectEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 #define START_HOOK_WITH_RETVAL(EVENT, ENTRY, RETVAL) \
     if (!ALEConfig::GetInstance().IsALEEnabled())\
@@ -28,7 +28,7 @@ using namespace Hooks;
     auto key = EntryKey<GameObjectEvents>(EVENT, ENTRY);\
     if (!GameObjectEventBindings->HasBindingsFor(key))\
         return RETVAL;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 void ALE::OnDummyEffect(WorldObject* pCaster, uint32 spellId, SpellEffIndex effIndex, GameObject* pTarget)
 {
@@ -42,11 +42,14 @@ void ALE::OnDummyEffect(WorldObject* pCaster, uint32 spellId, SpellEffIndex effI
 
 void ALE::UpdateAI(GameObject* pGameObject, uint32 diff)
 {
-    pGameObject->ALEEvents->Update(diff);
+    if (pGameObject->ALEEvents)
+        pGameObject->ALEEvents->Update(diff);
     START_HOOK(GAMEOBJECT_EVENT_ON_AIUPDATE, pGameObject->GetEntry());
-    Push(pGameObject);
-    Push(diff);
-    CallAllFunctions(GameObjectEventBindings, key);
+    hasGameObjectUpdateTimers.store(true, std::memory_order_relaxed);
+    CallUpdateFunctions(GameObjectEventBindings, key, gameObjectUpdateTimers[pGameObject], diff, [&]()
+    {
+        Push(pGameObject);
+    });
 }
 
 bool ALE::OnQuestAccept(Player* pPlayer, GameObject* pGameObject, Quest const* pQuest)
@@ -124,6 +127,15 @@ void ALE::OnAddToWorld(GameObject* pGameObject)
 
 void ALE::OnRemoveFromWorld(GameObject* pGameObject)
 {
+    // Keyed by pointer, DB spawned gameobjects share their GUID between instances of a map.
+    // Erased even if the update handlers are gone by now, they may have created the timers before.
+    // The gameobject's updates ran on this thread, so the relaxed load sees the flag set for its timers.
+    if (ALEConfig::GetInstance().IsALEEnabled() && hasGameObjectUpdateTimers.load(std::memory_order_relaxed))
+    {
+        LOCK_ALE_STATE;
+        gameObjectUpdateTimers.erase(pGameObject);
+    }
+
     START_HOOK(GAMEOBJECT_EVENT_ON_REMOVE, pGameObject->GetEntry());
     Push(pGameObject);
     CallAllFunctions(GameObjectEventBindings, key);
@@ -18,7 +18,7 @@ using namespace Hooks;
     auto key = EventKey<GroupEvents>(EVENT);\
     if (!GroupEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 void ALE::OnAddMember(Group* group, ObjectGuid guid)
 {
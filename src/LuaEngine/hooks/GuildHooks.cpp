@@ -18,7 +18,7 @@ using namespace Hooks;
     auto key = EventKey<GuildEvents>(EVENT);\
     if (!GuildEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 void ALE::OnAddMember(Guild* guild, Player* player, uint32 plRank)
 {
@@ -21,7 +21,7 @@ using namespace Hooks;
     auto instanceKey = EntryKey<InstanceEvents>(EVENT, AI->instance->GetInstanceId());\
     if (!MapEventBindings->HasBindingsFor(mapKey) && !InstanceEventBindings->HasBindingsFor(instanceKey))\
         return;\
-    LOCK_ALE;\
+    LOCK_ALE_STATE;\
     PushInstanceData(L, AI);\
     Push(AI->instance)
 
@@ -32,7 +32,7 @@ using namespace Hooks;
     auto instanceKey = EntryKey<InstanceEvents>(EVENT, AI->instance->GetInstanceId());\
     if (!MapEventBindings->HasBindingsFor(mapKey) && !InstanceEventBindings->HasBindingsFor(instanceKey))\
         return RETVAL;\
-    LOCK_ALE;\
+    LOCK_ALE_STATE;\
     PushInstanceData(L, AI);\
     Push(AI->instance)
 
@@ -50,9 +50,20 @@ void ALE::OnLoad(ALEInstanceAI* ai)
 
 void ALE::OnUpdateInstance(ALEInstanceAI* ai, uint32 diff)
 {
-    START_HOOK(INSTANCE_EVENT_ON_UPDATE, ai);
-    Push(diff);
-    CallAllFunctions(MapEventBindings, InstanceEventBindings, mapKey, instanceKey);
+    if (!ALEConfig::GetInstance().IsALEEnabled())
+        return;
+    auto mapKey = EntryKey<InstanceEvents>(INSTANCE_EVENT_ON_UPDATE, ai->instance->GetId());
+    auto instanceKey = EntryKey<InstanceEvents>(INSTANCE_EVENT_ON_UPDATE, ai->instance->GetInstanceId());
+    if (!MapEventBindings->HasBindingsFor(mapKey) && !InstanceEventBindings->HasBindingsFor(instanceKey))
+        return;
+    LOCK_ALE_STATE;
+
+    // The arguments are pushed again for every interval that is due
+    CallUpdateFunctions(MapEventBindings, InstanceEventBindings, mapKey, instanceKey, ai->updateTimers, diff, [&]()
+    {
+        PushInstanceData(L, ai);
+        Push(ai->instance);
+    });
 }
 
 void ALE::OnPlayerEnterInstance(ALEInstanceAI* ai, Player* player)
@@ -19,7 +19,7 @@ using namespace Hooks;
     auto key = EventKey<ServerEvents>(EVENT);\
     if (!ServerEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 #define START_HOOK_PACKET(EVENT, OPCODE) \
     if (!ALEConfig::GetInstance().IsALEEnabled())\
@@ -27,7 +27,7 @@ using namespace Hooks;
     auto key = EntryKey<PacketEvents>(EVENT, OPCODE);\
     if (!PacketEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 bool ALE::OnPacketSend(WorldSession* session, const WorldPacket& packet)
 {
@@ -42,7 +42,7 @@ bool ALE::OnPacketSend(WorldSession* session, const WorldPacket& packet)
 void ALE::OnPacketSendAny(Player* player, const WorldPacket& packet, bool& result)
 {
     START_HOOK_SERVER(SERVER_EVENT_ON_PACKET_SEND);
-    Push(new WorldPacket(packet));
+    PushView(packet);
     Push(player);
     int n = SetupStack(ServerEventBindings, key, 2);
 
@@ -62,7 +62,7 @@ void ALE::OnPacketSendAny(Player* player, const WorldPacket& packet, bool& resul
 void ALE::OnPacketSendOne(Player* player, const WorldPacket& packet, bool& result)
 {
     START_HOOK_PACKET(PACKET_EVENT_ON_PACKET_SEND, packet.GetOpcode());
-    Push(new WorldPacket(packet));
+    PushView(packet);
     Push(player);
     int n = SetupStack(PacketEventBindings, key, 2);
 
@@ -93,7 +93,7 @@ bool ALE::OnPacketReceive(WorldSession* session, WorldPacket const& packet)
 void ALE::OnPacketReceiveAny(Player* player, WorldPacket const& packet, bool& result)
 {
     START_HOOK_SERVER(SERVER_EVENT_ON_PACKET_RECEIVE);
-    Push(new WorldPacket(packet));
+    PushView(packet);
     Push(player);
     int n = SetupStack(ServerEventBindings, key, 2);
 
@@ -113,7 +113,7 @@ void ALE::OnPacketReceiveAny(Player* player, WorldPacket const& packet, bool& re
 void ALE::OnPacketReceiveOne(Player* player, WorldPacket const& packet, bool& result)
 {
     START_HOOK_PACKET(PACKET_EVENT_ON_PACKET_RECEIVE, packet.GetOpcode());
-    Push(new WorldPacket(packet));
+    PushView(packet);
     Push(player);
     int n = SetupStack(PacketEventBindings, key, 2);
 
@@ -19,7 +19,7 @@ using namespace Hooks;
     auto key = EventKey<PlayerEvents>(EVENT);\
     if (!PlayerEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 #define START_HOOK_WITH_RETVAL(EVENT, RETVAL) \
     if (!ALEConfig::GetInstance().IsALEEnabled())\
@@ -27,7 +27,65 @@ using namespace Hooks;
     auto key = EventKey<PlayerEvents>(EVENT);\
     if (!PlayerEventBindings->HasBindingsFor(key))\
         return RETVAL;\
-    LOCK_ALE
+    LOCK_ALE_STATE
+
+// Same as START_HOOK_WITH_RETVAL for events that support binding filters, `filterContext` is only built if the event has bindings
+#define START_FILTERED_HOOK_WITH_RETVAL(EVENT, CONTEXT, RETVAL) \
+    if (!ALEConfig::GetInstance().IsALEEnabled())\
+        return RETVAL;\
+    auto key = EventKey<PlayerEvents>(EVENT);\
+    if (!PlayerEventBindings->HasBindingsFor(key))\
+        return RETVAL;\
+    BindingFilterContext filterContext = CONTEXT;\
+    if (!PlayerEventBindings->HasBindingsFor(key, filterContext))\
+        return RETVAL;\
+    LOCK_ALE_STATE
+
+#define START_FILTERED_HOOK(EVENT, CONTEXT) START_FILTERED_HOOK_WITH_RETVAL(EVENT, CONTEXT, )
+
+// The filter properties every filtered player event has
+static BindingFilterContext GetPlayerFilterContext(Player* player)
+{
+    BindingFilterContext context;
+    if (!player)
+        return context;
+
+    context.Set(FILTER_MAP_ID, player->GetMapId());
+    context.Set(FILTER_ZONE_ID, player->GetZoneId());
+    context.Set(FILTER_CLASS, player->getClass());
+    return context;
+}
+
+static BindingFilterContext GetChatFilterContext(Player* player, uint32 type)
+{
+    BindingFilterContext context = GetPlayerFilterContext(player);
+    context.Set(FILTER_CHAT_TYPE, type);
+    return context;
+}
+
+// The zone filter checks the zone the player is entering
+static BindingFilterContext GetUpdateZoneFilterContext(Player* player, uint32 newZone)
+{
+    BindingFilterContext context = GetPlayerFilterContext(player);
+    context.Set(FILTER_ZONE_ID, newZone);
+    return context;
+}
+
+static BindingFilterContext GetSpellCastFilterContext(Player* player, Spell* spell)
+{
+    BindingFilterContext context = GetPlayerFilterContext(player);
+    if (spell)
+        context.Set(FILTER_SPELL_ID, spell->GetSpellInfo()->Id);
+    return context;
+}
+
+static BindingFilterContext GetDamageFilterContext(Player* player, Unit* target)
+{
+    BindingFilterContext context = GetPlayerFilterContext(player);
+    if (target)
+        context.Set(FILTER_ENTRY, target->GetEntry());
+    return context;
+}
 
 void ALE::OnLearnTalents(Player* pPlayer, uint32 talentId, uint32 talentRank, uint32 spellid)
 {
@@ -330,11 +388,11 @@ void ALE::OnTextEmote(Player* pPlayer, uint32 textEmote, uint32 emoteNum, Object
 
 void ALE::OnPlayerSpellCast(Player* pPlayer, Spell* pSpell, bool skipCheck)
 {
-    START_HOOK(PLAYER_EVENT_ON_SPELL_CAST);
+    START_FILTERED_HOOK(PLAYER_EVENT_ON_SPELL_CAST, GetSpellCastFilterContext(pPlayer, pSpell));
     Push(pPlayer);
     Push(pSpell);
     Push(skipCheck);
-    CallAllFunctions(PlayerEventBindings, key);
+    CallAllFunctions(PlayerEventBindings, key, &filterContext);
 }
 
 void ALE::OnLogin(Player* pPlayer)
@@ -393,11 +451,11 @@ void ALE::OnUpdateArea(Player* pPlayer, uint32 oldArea, uint32 newArea)
 
 void ALE::OnUpdateZone(Player* pPlayer, uint32 newZone, uint32 newArea)
 {
-    START_HOOK(PLAYER_EVENT_ON_UPDATE_ZONE);
+    START_FILTERED_HOOK(PLAYER_EVENT_ON_UPDATE_ZONE, GetUpdateZoneFilterContext(pPlayer, newZone));
     Push(pPlayer);
     Push(newZone);
     Push(newArea);
-    CallAllFunctions(PlayerEventBindings, key);
+    CallAllFunctions(PlayerEventBindings, key, &filterContext);
 }
 
 void ALE::OnMapChanged(Player* player)
@@ -412,13 +470,13 @@ bool ALE::OnChat(Player* pPlayer, uint32 type, uint32 lang, std::string& msg)
     if (lang == LANG_ADDON)
         return OnAddonMessage(pPlayer, type, msg, NULL, NULL, NULL, NULL);
 
-    START_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_CHAT, true);
+    START_FILTERED_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_CHAT, GetChatFilterContext(pPlayer, type), true);
     bool result = true;
     Push(pPlayer);
     Push(msg);
     Push(type);
     Push(lang);
-    int n = SetupStack(PlayerEventBindings, key, 4);
+    int n = SetupStack(PlayerEventBindings, key, 4, &filterContext);
 
     while (n > 0)
     {
@@ -442,14 +500,14 @@ bool ALE::OnChat(Player* pPlayer, uint32 type, uint32 lang, std::string& msg, Gr
     if (lang == LANG_ADDON)
         return OnAddonMessage(pPlayer, type, msg, NULL, NULL, pGroup, NULL);
 
-    START_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_GROUP_CHAT, true);
+    START_FILTERED_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_GROUP_CHAT, GetChatFilterContext(pPlayer, type), true);
     bool result = true;
     Push(pPlayer);
     Push(msg);
     Push(type);
     Push(lang);
     Push(pGroup);
-    int n = SetupStack(PlayerEventBindings, key, 5);
+    int n = SetupStack(PlayerEventBindings, key, 5, &filterContext);
 
     while (n > 0)
     {
@@ -473,14 +531,14 @@ bool ALE::OnChat(Player* pPlayer, uint32 type, uint32 lang, std::string& msg, Gu
     if (lang == LANG_ADDON)
         return OnAddonMessage(pPlayer, type, msg, NULL, pGuild, NULL, NULL);
 
-    START_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_GUILD_CHAT, true);
+    START_FILTERED_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_GUILD_CHAT, GetChatFilterContext(pPlayer, type), true);
     bool result = true;
     Push(pPlayer);
     Push(msg);
     Push(type);
     Push(lang);
     Push(pGuild);
-    int n = SetupStack(PlayerEventBindings, key, 5);
+    int n = SetupStack(PlayerEventBindings, key, 5, &filterContext);
 
     while (n > 0)
     {
@@ -504,14 +562,14 @@ bool ALE::OnChat(Player* pPlayer, uint32 type, uint32 lang, std::string& msg, Ch
     if (lang == LANG_ADDON)
         return OnAddonMessage(pPlayer, type, msg, NULL, NULL, NULL, pChannel);
 
-    START_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_CHANNEL_CHAT, true);
+    START_FILTERED_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_CHANNEL_CHAT, GetChatFilterContext(pPlayer, type), true);
     bool result = true;
     Push(pPlayer);
     Push(msg);
     Push(type);
     Push(lang);
     Push(pChannel->IsConstant() ? static_cast<int32>(pChannel->GetChannelId()) : -static_cast<int32>(pChannel->GetChannelDBId()));
-    int n = SetupStack(PlayerEventBindings, key, 5);
+    int n = SetupStack(PlayerEventBindings, key, 5, &filterContext);
 
     while (n > 0)
     {
@@ -535,14 +593,14 @@ bool ALE::OnChat(Player* pPlayer, uint32 type, uint32 lang, std::string& msg, Pl
     if (lang == LANG_ADDON)
         return OnAddonMessage(pPlayer, type, msg, pReceiver, NULL, NULL, NULL);
 
-    START_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_WHISPER, true);
+    START_FILTERED_HOOK_WITH_RETVAL(PLAYER_EVENT_ON_WHISPER, GetChatFilterContext(pPlayer, type), true);
     bool result = true;
     Push(pPlayer);
     Push(msg);
     Push(type);
     Push(lang);
     Push(pReceiver);
-    int n = SetupStack(PlayerEventBindings, key, 5);
+    int n = SetupStack(PlayerEventBindings, key, 5, &filterContext);
 
     while (n > 0)
     {
@@ -811,13 +869,13 @@ void ALE::OnPlayerHeal(Player* player, Unit* target, uint32& gain)
 
 void ALE::OnPlayerDamage(Player* player, Unit* target, uint32& damage)
 {
-    START_HOOK(PLAYER_EVENT_ON_DAMAGE);
+    START_FILTERED_HOOK(PLAYER_EVENT_ON_DAMAGE, GetDamageFilterContext(player, target));
     Push(player);
     Push(target);
     Push(damage);
 
     int damageIndex = lua_gettop(L);
-    int n = SetupStack(PlayerEventBindings, key, 3);
+    int n = SetupStack(PlayerEventBindings, key, 3, &filterContext);
     while (n > 0)
     {
         int r = CallOneFunction(n--, 3, 1);
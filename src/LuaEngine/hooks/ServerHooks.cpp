@@ -20,7 +20,7 @@ using namespace Hooks;
     auto key = EventKey<ServerEvents>(EVENT);\
     if (!ServerEventBindings->HasBindingsFor(key))\
         return;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 #define START_HOOK_WITH_RETVAL(EVENT, RETVAL) \
     if (!ALEConfig::GetInstance().IsALEEnabled())\
@@ -28,7 +28,7 @@ using namespace Hooks;
     auto key = EventKey<ServerEvents>(EVENT);\
     if (!ServerEventBindings->HasBindingsFor(key))\
         return RETVAL;\
-    LOCK_ALE
+    LOCK_ALE_STATE
 
 bool ALE::OnAddonMessage(Player* sender, uint32 type, std::string& msg, Player* receiver, Guild* guild, Group* group, Channel* channel)
 {
@@ -66,7 +66,7 @@ bool ALE::OnAddonMessage(Player* sender, uint32 type, std::string& msg, Player*
 
 void ALE::OnTimedEvent(int funcRef, uint32 delay, uint32 calls, WorldObject* obj)
 {
-    LOCK_ALE;
+    LOCK_ALE_STATE;
     ASSERT(!event_level);
 
     // Get function
@@ -258,7 +258,8 @@ void ALE::OnWorldUpdate(uint32 diff)
     }
 
     eventMgr->globalProcessor->Update(diff);
-    httpManager.HandleHttpResponses();
+    coroutineScheduler.Update(this, diff);
+    httpManager.HandleHttpResponses(this);
     queryProcessor.ProcessReadyCallbacks();
 
     START_HOOK(WORLD_EVENT_ON_UPDATE);
@@ -288,6 +289,11 @@ void ALE::OnCreate(Map* map)
 
 void ALE::OnDestroy(Map* map)
 {
+    {
+        LOCK_ALE_STATE;
+        mapUpdateTimers.erase(map);
+    }
+
     START_HOOK(MAP_EVENT_ON_DESTROY);
     Push(map);
     CallAllFunctions(ServerEventBindings, key);
@@ -311,12 +317,23 @@ void ALE::OnPlayerLeave(Map* map, Player* player)
 
 void ALE::OnUpdate(Map* map, uint32 diff)
 {
+    // Map states do here what the world state does in OnWorldUpdate
+    if (boundMap)
+    {
+        if (reloadPending)
+            ReloadMapState();
+
+        eventMgr->globalProcessor->Update(diff);
+        coroutineScheduler.Update(this, diff);
+        httpManager.HandleHttpResponses(this);
+        queryProcessor.ProcessReadyCallbacks();
+    }
+
     START_HOOK(MAP_EVENT_ON_UPDATE);
-    // enable this for multithread
-    // eventMgr->globalProcessor->Update(diff);
-    Push(map);
-    Push(diff);
-    CallAllFunctions(ServerEventBindings, key);
+    CallUpdateFunctions(ServerEventBindings, key, mapUpdateTimers[map], diff, [&]()
+    {
+        Push(map);
+    });
 }
 
 void ALE::OnRemove(GameObject* gameobject)
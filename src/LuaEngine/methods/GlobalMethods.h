@@ -146,8 +146,7 @@ namespace LuaGlobalFunctions
      */
     int GetStateMap(lua_State* L)
     {
-        // Until AC supports multistate, this will always return nil
-        ALE::Push(L);
+        ALE::Push(L, ALE::GetALE(L)->GetBoundMap());
         return 1;
     }
 
@@ -158,8 +157,8 @@ namespace LuaGlobalFunctions
      */
     int GetStateMapId(lua_State* L)
     {
-        // Until AC supports multistate, this will always return -1
-        ALE::Push(L, -1);
+        Map* map = ALE::GetALE(L)->GetBoundMap();
+        ALE::Push(L, map ? static_cast<int32>(map->GetId()) : -1);
         return 1;
     }
 
@@ -170,8 +169,8 @@ namespace LuaGlobalFunctions
      */
     int GetStateInstanceId(lua_State* L)
     {
-        // Until AC supports multistate, this will always return 0
-        ALE::Push(L, 0);
+        Map* map = ALE::GetALE(L)->GetBoundMap();
+        ALE::Push(L, map ? map->GetInstanceId() : 0);
         return 1;
     }
 
@@ -590,32 +589,117 @@ namespace LuaGlobalFunctions
         return 1;
     }
 
+    // Checks a table of entries and {min, max} entry ranges, the ranges are read by `ALE::RegisterEntries`.
+    // Only uses the Lua API so that no C++ objects are alive when an argument error is raised.
+    static void CheckEntryRanges(lua_State* L, int narg)
+    {
+        luaL_checktype(L, narg, LUA_TTABLE);
+
+        int count = static_cast<int>(lua_rawlen(L, narg));
+        if (!count)
+            luaL_argerror(L, narg, "entry table is empty");
+
+        for (int i = 1; i <= count; ++i)
+        {
+            lua_rawgeti(L, narg, i);
+            if (lua_istable(L, -1))
+            {
+                lua_rawgeti(L, -1, 1);
+                lua_rawgeti(L, -2, 2);
+                if (!lua_isnumber(L, -2) || !lua_isnumber(L, -1))
+                    luaL_argerror(L, narg, "entry ranges must be {min, max}");
+
+                if (static_cast<uint32>(lua_tointeger(L, -2)) > static_cast<uint32>(lua_tointeger(L, -1)))
+                    luaL_argerror(L, narg, "entry range min is larger than max");
+                lua_pop(L, 2);
+            }
+            else if (!lua_isnumber(L, -1))
+                luaL_argerror(L, narg, "entries must be numbers or {min, max} ranges");
+            lua_pop(L, 1);
+        }
+    }
+
     static int RegisterEntryHelper(lua_State* L, int regtype)
     {
-        uint32 id = ALE::CHECKVAL<uint32>(L, 1);
+        bool ranged = lua_istable(L, 1);
+        uint32 id = 0;
+        if (ranged)
+            CheckEntryRanges(L, 1);
+        else
+            id = ALE::CHECKVAL<uint32>(L, 1);
         uint32 ev = ALE::CHECKVAL<uint32>(L, 2);
         luaL_checktype(L, 3, LUA_TFUNCTION);
         uint32 shots = ALE::CHECKVAL<uint32>(L, 4, 0);
+        uint32 interval = ALE::CHECKVAL<uint32>(L, 5, 0);
 
         lua_pushvalue(L, 3);
         int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
+        if (functionRef >= 0 && ranged)
+            return ALE::GetALE(L)->RegisterEntries(L, regtype, 1, ev, functionRef, shots, interval);
         if (functionRef >= 0)
-            return ALE::GetALE(L)->Register(L, regtype, id, ObjectGuid(), 0, ev, functionRef, shots);
+            return ALE::GetALE(L)->Register(L, regtype, id, ObjectGuid(), 0, ev, functionRef, shots, interval);
         else
             luaL_argerror(L, 3, "unable to make a ref to function");
         return 0;
     }
 
+    // Checks a table of filter fields with a value or a table of values each, the filter is read by `ALE::Register`.
+    // Only uses the Lua API so that no C++ objects are alive when an argument error is raised.
+    static void CheckBindingFilter(lua_State* L, int narg)
+    {
+        luaL_checktype(L, narg, LUA_TTABLE);
+
+        lua_pushnil(L);
+        while (lua_next(L, narg))
+        {
+            // Stack: key, value
+            if (lua_type(L, -2) != LUA_TSTRING)
+                luaL_argerror(L, narg, "filter keys must be field names");
+
+            const char* name = lua_tostring(L, -2);
+            BindingFilterField field;
+            if (!GetBindingFilterField(name, field))
+                luaL_argerror(L, narg, lua_pushfstring(L, "unknown filter field '%s'", name));
+
+            if (lua_istable(L, -1))
+            {
+                int count = static_cast<int>(lua_rawlen(L, -1));
+                for (int i = 1; i <= count; ++i)
+                {
+                    lua_rawgeti(L, -1, i);
+                    if (!lua_isnumber(L, -1))
+                        luaL_argerror(L, narg, lua_pushfstring(L, "filter field '%s' must have numeric values", name));
+                    lua_pop(L, 1);
+                }
+            }
+            else if (!lua_isnumber(L, -1))
+                luaL_argerror(L, narg, lua_pushfstring(L, "filter field '%s' must be a number or a table of numbers", name));
+
+            lua_pop(L, 1);
+            // Stack: key
+        }
+    }
+
     static int RegisterEventHelper(lua_State* L, int regtype)
     {
         uint32 ev = ALE::CHECKVAL<uint32>(L, 1);
         luaL_checktype(L, 2, LUA_TFUNCTION);
         uint32 shots = ALE::CHECKVAL<uint32>(L, 3, 0);
+        uint32 interval = 0;
+        int filterIndex = 0;
+        // The filter takes the place of the interval, which no filtered event has
+        if (lua_istable(L, 4))
+        {
+            CheckBindingFilter(L, 4);
+            filterIndex = 4;
+        }
+        else
+            interval = ALE::CHECKVAL<uint32>(L, 4, 0);
 
         lua_pushvalue(L, 2);
         int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
         if (functionRef >= 0)
-            return ALE::GetALE(L)->Register(L, regtype, 0, ObjectGuid(), 0, ev, functionRef, shots);
+            return ALE::GetALE(L)->Register(L, regtype, 0, ObjectGuid(), 0, ev, functionRef, shots, interval, filterIndex);
         else
             luaL_argerror(L, 2, "unable to make a ref to function");
         return 0;
@@ -628,11 +712,12 @@ namespace LuaGlobalFunctions
         uint32 ev = ALE::CHECKVAL<uint32>(L, 3);
         luaL_checktype(L, 4, LUA_TFUNCTION);
         uint32 shots = ALE::CHECKVAL<uint32>(L, 5, 0);
+        uint32 interval = ALE::CHECKVAL<uint32>(L, 6, 0);
 
         lua_pushvalue(L, 4);
         int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
         if (functionRef >= 0)
-            return ALE::GetALE(L)->Register(L, regtype, 0, guid, instanceId, ev, functionRef, shots);
+            return ALE::GetALE(L)->Register(L, regtype, 0, guid, instanceId, ev, functionRef, shots, interval);
         else
             luaL_argerror(L, 4, "unable to make a ref to function");
         return 0;
@@ -701,10 +786,12 @@ namespace LuaGlobalFunctions
      *
      * @proto cancel = (event, function)
      * @proto cancel = (event, function, shots)
+     * @proto cancel = (event, function, shots, interval)
      *
      * @param uint32 event : server event ID, refer to ServerEvents above
      * @param function function : function that will be called when the event occurs
      * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 interval = 0 : only for `MAP_EVENT_ON_UPDATE`, the minimum time in milliseconds between calls for each map, the handler gets the time since its last call as diff
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -799,10 +886,12 @@ namespace LuaGlobalFunctions
      *
      * @proto cancel = (event, function)
      * @proto cancel = (event, function, shots)
+     * @proto cancel = (event, function, shots, filter)
      *
      * @param uint32 event : [Player] event Id, refer to PlayerEvents above
      * @param function function : function to register
      * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param table filter : only call the function for matching events, checked before entering Lua. A table of fields with a value or a table of values each: `map`, `zone` and `class` for `PLAYER_EVENT_ON_SPELL_CAST`, `PLAYER_EVENT_ON_DAMAGE`, `PLAYER_EVENT_ON_UPDATE_ZONE` and the chat events, `spell` for `PLAYER_EVENT_ON_SPELL_CAST`, `entry` (of the target) for `PLAYER_EVENT_ON_DAMAGE` and `chatType` for the chat events
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -952,10 +1041,10 @@ namespace LuaGlobalFunctions
      * @proto cancel = (entry, event, function)
      * @proto cancel = (entry, event, function, shots)
      *
-     * @param uint32 entry : [Creature] entry Id
+     * @param uint32 entry : [Creature] entry Id, or a table of entry Ids and `{min, max}` entry ranges sharing the function
      * @param uint32 event : [Creature] gossip event Id, refer to GossipEvents above
      * @param function function : function to register
-     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function", counted together for all entries of a table
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -979,10 +1068,10 @@ namespace LuaGlobalFunctions
      * @proto cancel = (entry, event, function)
      * @proto cancel = (entry, event, function, shots)
      *
-     * @param uint32 entry : [GameObject] entry Id
+     * @param uint32 entry : [GameObject] entry Id, or a table of entry Ids and `{min, max}` entry ranges sharing the function
      * @param uint32 event : [GameObject] gossip event Id, refer to GossipEvents above
      * @param function function : function to register
-     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function", counted together for all entries of a table
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -1009,10 +1098,10 @@ namespace LuaGlobalFunctions
      * @proto cancel = (entry, event, function)
      * @proto cancel = (entry, event, function, shots)
      *
-     * @param uint32 entry : [Item] entry Id
+     * @param uint32 entry : [Item] entry Id, or a table of entry Ids and `{min, max}` entry ranges sharing the function
      * @param uint32 event : [Item] event Id, refer to ItemEvents above
      * @param function function : function to register
-     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function", counted together for all entries of a table
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -1036,10 +1125,10 @@ namespace LuaGlobalFunctions
      * @proto cancel = (entry, event, function)
      * @proto cancel = (entry, event, function, shots)
      *
-     * @param uint32 entry : [Item] entry Id
+     * @param uint32 entry : [Item] entry Id, or a table of entry Ids and `{min, max}` entry ranges sharing the function
      * @param uint32 event : [Item] gossip event Id, refer to GossipEvents above
      * @param function function : function to register
-     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function", counted together for all entries of a table
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -1069,6 +1158,7 @@ namespace LuaGlobalFunctions
      * @param uint32 event : [Map] event ID, refer to MapEvents above
      * @param function function : function to register
      * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 interval = 0 : only for `INSTANCE_EVENT_ON_UPDATE`, the minimum time in milliseconds between calls for each instance, the handler gets the time since its last call as diff
      */
     int RegisterMapEvent(lua_State* L)
     {
@@ -1096,6 +1186,7 @@ namespace LuaGlobalFunctions
      * @param uint32 event : [Map] event ID, refer to MapEvents above
      * @param function function : function to register
      * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 interval = 0 : only for `INSTANCE_EVENT_ON_UPDATE`, the minimum time in milliseconds between calls for each instance, the handler gets the time since its last call as diff
      */
     int RegisterInstanceEvent(lua_State* L)
     {
@@ -1189,11 +1280,13 @@ namespace LuaGlobalFunctions
      *
      * @proto cancel = (entry, event, function)
      * @proto cancel = (entry, event, function, shots)
+     * @proto cancel = (entry, event, function, shots, interval)
      *
-     * @param uint32 entry : the ID of one or more [Creature]s
+     * @param uint32 entry : the ID of one or more [Creature]s, or a table of IDs and `{min, max}` ID ranges sharing the function
      * @param uint32 event : refer to CreatureEvents above
      * @param function function : function that will be called when the event occurs
-     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function", counted together for all entries of a table
+     * @param uint32 interval = 0 : only for `CREATURE_EVENT_ON_AIUPDATE`, the minimum time in milliseconds between calls for each object, the handler gets the time since its last call as diff. Returning true suppresses the default AI until the handler is called again
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -1260,12 +1353,14 @@ namespace LuaGlobalFunctions
      *
      * @proto cancel = (guid, instance_id, event, function)
      * @proto cancel = (guid, instance_id, event, function, shots)
+     * @proto cancel = (guid, instance_id, event, function, shots, interval)
      *
      * @param ObjectGuid guid : the GUID of a single [Creature]
      * @param uint32 instance_id : the instance ID of a single [Creature]
      * @param uint32 event : refer to CreatureEvents above
      * @param function function : function that will be called when the event occurs
      * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 interval = 0 : only for `CREATURE_EVENT_ON_AIUPDATE`, the minimum time in milliseconds between calls for each object, the handler gets the time since its last call as diff. Returning true suppresses the default AI until the handler is called again
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -1300,11 +1395,13 @@ namespace LuaGlobalFunctions
      *
      * @proto cancel = (entry, event, function)
      * @proto cancel = (entry, event, function, shots)
+     * @proto cancel = (entry, event, function, shots, interval)
      *
-     * @param uint32 entry : [GameObject] entry Id
+     * @param uint32 entry : [GameObject] entry Id, or a table of entry Ids and `{min, max}` entry ranges sharing the function
      * @param uint32 event : [GameObject] event Id, refer to GameObjectEvents above
      * @param function function : function to register
-     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function", counted together for all entries of a table
+     * @param uint32 interval = 0 : only for `GAMEOBJECT_EVENT_ON_AIUPDATE`, the minimum time in milliseconds between calls for each object, the handler gets the time since its last call as diff
      *
      * @return function cancel : a function that cancels the binding when called
      */
@@ -1350,10 +1447,10 @@ namespace LuaGlobalFunctions
      * };
      * </pre>
      *
-     * @param uint32 entry : [Spell] entry Id
+     * @param uint32 entry : [Spell] entry Id, or a table of entry Ids and `{min, max}` entry ranges sharing the function
      * @param uint32 event : event ID, refer to SpellEvents above
      * @param function function : function to register
-     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function"
+     * @param uint32 shots = 0 : the number of times the function will be called, 0 means "always call this function", counted together for all entries of a table
      */
     int RegisterSpellEvent(lua_State* L)
     {
@@ -1436,8 +1533,17 @@ namespace LuaGlobalFunctions
     static int DBQueryAsync(lua_State* L, DatabaseWorkerPool<T>& db)
     {
         const char* query = ALE::CHECKVAL<const char*>(L, 1);
-        luaL_checktype(L, 2, LUA_TFUNCTION);
-        lua_pushvalue(L, 2);
+        ALE* E = ALE::GetALE(L);
+
+        // Without a callback a coroutine waits for the result instead
+        bool wait = lua_isnoneornil(L, 2) && E->coroutineScheduler.IsCoroutine(L);
+        if (wait)
+            E->coroutineScheduler.PushResumer(L);
+        else
+        {
+            luaL_checktype(L, 2, LUA_TFUNCTION);
+            lua_pushvalue(L, 2);
+        }
         int funcRef = luaL_ref(L, LUA_REGISTRYINDEX);
         if (funcRef == LUA_REFNIL || funcRef == LUA_NOREF)
         {
@@ -1445,11 +1551,14 @@ namespace LuaGlobalFunctions
             return 0;
         }
 
-        ALE::GALE->queryProcessor.AddCallback(db.AsyncQuery(query).WithCallback([L, funcRef](QueryResult result)
+        E->queryProcessor.AddCallback(db.AsyncQuery(query).WithCallback([E, funcRef](QueryResult result)
             {
                 ALEQuery* eq = result ? new ALEQuery(result) : nullptr;
 
-                LOCK_ALE;
+                ALE::Guard guard(E->GetStateLock());
+
+                // The calling coroutine may be gone, always call from the main state
+                lua_State* L = E->L;
 
                 // Get function
                 lua_rawgeti(L, LUA_REGISTRYINDEX, funcRef);
@@ -1458,11 +1567,13 @@ namespace LuaGlobalFunctions
                 ALE::Push(L, eq);
 
                 // Call function
-                ALE::GALE->ExecuteCall(1, 0);
+                E->ExecuteCall(1, 0);
 
                 luaL_unref(L, LUA_REGISTRYINDEX, funcRef);
             }));
 
+        if (wait)
+            return ALECoroutineScheduler::PushWaitRequest(L);
         return 0;
     }
 
@@ -1516,6 +1627,9 @@ namespace LuaGlobalFunctions
      *         end
      *     end)
      *
+     * Inside a coroutine started with [Global:StartCoroutine] the callback can be omitted,
+     *   the coroutine then waits for the results and they are returned.
+     *
      * @param string sql : query to execute
      * @param function callback : function that will be called when the results are available
      */
@@ -1586,6 +1700,9 @@ namespace LuaGlobalFunctions
      *
      * For an example see [Global:WorldDBQueryAsync].
      *
+     * Inside a coroutine started with [Global:StartCoroutine] the callback can be omitted,
+     *   the coroutine then waits for the results and they are returned.
+     *
      * @param string sql : query to execute
      * @param function callback : function that will be called when the results are available
      */
@@ -1656,6 +1773,9 @@ namespace LuaGlobalFunctions
      *
      * For an example see [Global:WorldDBQueryAsync].
      *
+     * Inside a coroutine started with [Global:StartCoroutine] the callback can be omitted,
+     *   the coroutine then waits for the results and they are returned.
+     *
      * @param string sql : query to execute
      * @param function callback : function that will be called when the results are available
      */
@@ -1774,6 +1894,80 @@ namespace LuaGlobalFunctions
         return 0;
     }
 
+    /**
+     * Runs the function as a coroutine that can wait with [Global:Sleep], [Global:WaitForEvent]
+     *   and the asynchronous functions called without a callback.
+     *
+     * The function runs immediately until it waits for the first time.
+     * Objects passed to or fetched by the coroutine are only valid until it waits, fetch them again afterwards.
+     *
+     *     StartCoroutine(function(guid)
+     *         SendWorldMessage("Restarting soon")
+     *         Sleep(5000)
+     *         local Q = WorldDBQueryAsync("SELECT COUNT(*) FROM creature")
+     *         SendWorldMessage("Creatures: " .. Q:GetUInt32(0))
+     *     end)
+     *
+     * @param function function : function to run as a coroutine
+     * @param ... : arguments passed to the function
+     */
+    int StartCoroutine(lua_State* L)
+    {
+        luaL_checktype(L, 1, LUA_TFUNCTION);
+
+        ALE* E = ALE::GetALE(L);
+        E->coroutineScheduler.Start(E, L, lua_gettop(L) - 1);
+        return 0;
+    }
+
+    /**
+     * Pauses the calling coroutine for the given time.
+     *
+     * Can only be called from a coroutine started with [Global:StartCoroutine].
+     *
+     * @param uint32 delay : time in milliseconds to wait for
+     */
+    int Sleep(lua_State* L)
+    {
+        uint32 delay = ALE::CHECKVAL<uint32>(L, 1);
+
+        ALE* E = ALE::GetALE(L);
+        if (!E->coroutineScheduler.IsCoroutine(L))
+            return luaL_error(L, "Sleep can only be called from a coroutine started with StartCoroutine");
+
+        E->coroutineScheduler.Sleep(L, delay);
+        return ALECoroutineScheduler::PushWaitRequest(L);
+    }
+
+    /**
+     * Pauses the calling coroutine until an event registered with the passed function triggers once and returns the event's arguments.
+     *
+     * The register function is called with the passed arguments followed by the handler and `shots` 1.
+     * Can only be called from a coroutine started with [Global:StartCoroutine].
+     *
+     *     local event, player, msg = WaitForEvent(RegisterPlayerEvent, 18)
+     *
+     * @param function register : function registering the event, for example [Global:RegisterServerEvent]
+     * @param ... : arguments passed to the register function before the handler
+     * @return ... : arguments the event handler was called with
+     */
+    int WaitForEvent(lua_State* L)
+    {
+        luaL_checktype(L, 1, LUA_TFUNCTION);
+
+        ALE* E = ALE::GetALE(L);
+        if (!E->coroutineScheduler.IsCoroutine(L))
+            return luaL_error(L, "WaitForEvent can only be called from a coroutine started with StartCoroutine");
+
+        // Stack: register, [arguments]
+        E->coroutineScheduler.PushResumer(L);
+        ALE::Push(L, 1);
+        // Stack: register, [arguments], resumer, shots
+        lua_call(L, lua_gettop(L) - 1, 0);
+
+        return ALECoroutineScheduler::PushWaitRequest(L);
+    }
+
     /**
      * Performs an in-game spawn and returns the [Creature] or [GameObject] spawned.
      *
@@ -2417,8 +2611,7 @@ namespace LuaGlobalFunctions
      */
     int IsCompatibilityMode(lua_State* L)
     {
-        // Until AC supports multistate, this will always return true
-        ALE::Push(L, true);
+        ALE::Push(L, !ALE::IsMultiStateEnabled());
         return 1;
     }
 
@@ -2655,7 +2848,7 @@ namespace LuaGlobalFunctions
      * @param table headers : a table with string key-value pairs containing the request headers
      * @param string body : the request's body (only used for POST, PUT and PATCH requests)
      * @param string contentType : the body's content-type
-     * @param function function : function that will be called when the request is executed
+     * @param function function : function that will be called when the request is executed, can be omitted inside a coroutine started with [Global:StartCoroutine] to wait for and return `status, body, headers`
      */
     int HttpRequest(lua_State* L)
     {
@@ -2695,17 +2888,25 @@ namespace LuaGlobalFunctions
             }
         }
 
-        lua_pushvalue(L, callbackIdx);
+        // Without a callback a coroutine waits for the response instead
+        ALE* E = ALE::GetALE(L);
+        bool wait = lua_isnoneornil(L, callbackIdx) && E->coroutineScheduler.IsCoroutine(L);
+        if (wait)
+            E->coroutineScheduler.PushResumer(L);
+        else
+            lua_pushvalue(L, callbackIdx);
         int funcRef = luaL_ref(L, LUA_REGISTRYINDEX);
         if (funcRef >= 0)
         {
-            ALE::GALE->httpManager.PushRequest(new HttpWorkItem(funcRef, httpVerb, url, body, bodyContentType, headers));
+            E->httpManager.PushRequest(new HttpWorkItem(funcRef, httpVerb, url, body, bodyContentType, headers));
         }
         else
         {
             luaL_argerror(L, callbackIdx, "unable to make a ref to function");
         }
 
+        if (wait)
+            return ALECoroutineScheduler::PushWaitRequest(L);
         return 0;
     }
 
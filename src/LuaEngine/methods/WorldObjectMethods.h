@@ -765,6 +765,15 @@ namespace LuaWorldObject
         if (min > max)
             return luaL_argerror(L, 3, "min is bigger than max delay");
 
+        // Most objects never get timed events, the processor is only created when needed.
+        // Players keep their timed events in the world state when changing maps
+        if (!obj->ALEEvents)
+            obj->ALEEvents = new ALEEventProcessor(obj->IsPlayer() ? &ALE::GALE : ALE::GetStatePtrFor(obj->FindMap()), obj);
+
+        // With multistate the object's events may be run by the state of another map
+        if (!obj->ALEEvents->IsOwnedBy(ALE::GetALE(L)))
+            return luaL_error(L, "timed events of this object are handled by another Lua state");
+
         lua_pushvalue(L, 2);
         int functionRef = luaL_ref(L, LUA_REGISTRYINDEX);
         if (functionRef != LUA_REFNIL && functionRef != LUA_NOREF)
@@ -783,7 +792,8 @@ namespace LuaWorldObject
     int RemoveEventById(lua_State* L, WorldObject* obj)
     {
         int eventId = ALE::CHECKVAL<int>(L, 2);
-        obj->ALEEvents->SetState(eventId, LUAEVENT_STATE_ABORT);
+        if (obj->ALEEvents && obj->ALEEvents->IsOwnedBy(ALE::GetALE(L)))
+            obj->ALEEvents->SetState(eventId, LUAEVENT_STATE_ABORT);
         return 0;
     }
 
@@ -791,9 +801,10 @@ namespace LuaWorldObject
      * Removes all timed events from a [WorldObject]
      *
      */
-    int RemoveEvents(lua_State* /*L*/, WorldObject* obj)
+    int RemoveEvents(lua_State* L, WorldObject* obj)
     {
-        obj->ALEEvents->SetStates(LUAEVENT_STATE_ABORT);
+        if (obj->ALEEvents && obj->ALEEvents->IsOwnedBy(ALE::GetALE(L)))
+            obj->ALEEvents->SetStates(LUAEVENT_STATE_ABORT);
         return 0;
     }
 
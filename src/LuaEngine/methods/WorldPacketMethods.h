@@ -20,6 +20,76 @@
  */
 namespace LuaPacket
 {
+    // Reads the packet at the read position of its Lua object. Views of the core's packet
+    // (see ALETemplate<WorldPacket>::PrepareCall) keep their own position, so reading them
+    // neither copies nor changes the core's packet, which other threads may be reading too
+    class PacketReader
+    {
+    public:
+        PacketReader(lua_State* L, WorldPacket* packet) : packet(packet), view(ALE::CHECKTYPE(L, 1, ALETemplate<WorldPacket>::tname, false))
+        {
+            if (view && !view->IsView())
+                view = nullptr;
+        }
+
+        template<typename T>
+        T Read()
+        {
+            if (!view)
+            {
+                T value;
+                (*packet) >> value;
+                return value;
+            }
+
+            T value = packet->read<T>(view->GetViewPosition());
+            view->SetViewPosition(view->GetViewPosition() + sizeof(T));
+            return value;
+        }
+
+        uint64 ReadPackedGUID()
+        {
+            uint64 guid = 0;
+            if (!view)
+            {
+                packet->readPackGUID(guid);
+                return guid;
+            }
+
+            uint8 mask = Read<uint8>();
+            for (uint8 i = 0; i < 8; ++i)
+                if (mask & (1 << i))
+                    guid |= uint64(Read<uint8>()) << (i * 8);
+            return guid;
+        }
+
+        std::string ReadString()
+        {
+            std::string value;
+            if (!view)
+            {
+                (*packet) >> value;
+                return value;
+            }
+
+            // Up to the terminating zero or the end of the packet, like ByteBuffer
+            uint32 pos = view->GetViewPosition();
+            while (pos < packet->size())
+            {
+                char c = packet->read<char>(pos++);
+                if (!c)
+                    break;
+                value += c;
+            }
+            view->SetViewPosition(pos);
+            return value;
+        }
+
+    private:
+        WorldPacket* packet;
+        ALEObject* view;
+    };
+
     /**
      * Returns the opcode of the [WorldPacket].
      *
@@ -63,8 +133,7 @@ namespace LuaPacket
      */
     int ReadByte(lua_State* L, WorldPacket* packet)
     {
-        int8 _byte;
-        (*packet) >> _byte;
+        int8 _byte = PacketReader(L, packet).Read<int8>();
         ALE::Push(L, _byte);
         return 1;
     }
@@ -76,8 +145,7 @@ namespace LuaPacket
      */
     int ReadUByte(lua_State* L, WorldPacket* packet)
     {
-        uint8 _ubyte;
-        (*packet) >> _ubyte;
+        uint8 _ubyte = PacketReader(L, packet).Read<uint8>();
         ALE::Push(L, _ubyte);
         return 1;
     }
@@ -89,8 +157,7 @@ namespace LuaPacket
      */
     int ReadShort(lua_State* L, WorldPacket* packet)
     {
-        int16 _short;
-        (*packet) >> _short;
+        int16 _short = PacketReader(L, packet).Read<int16>();
         ALE::Push(L, _short);
         return 1;
     }
@@ -102,8 +169,7 @@ namespace LuaPacket
      */
     int ReadUShort(lua_State* L, WorldPacket* packet)
     {
-        uint16 _ushort;
-        (*packet) >> _ushort;
+        uint16 _ushort = PacketReader(L, packet).Read<uint16>();
         ALE::Push(L, _ushort);
         return 1;
     }
@@ -115,8 +181,7 @@ namespace LuaPacket
      */
     int ReadLong(lua_State* L, WorldPacket* packet)
     {
-        int32 _long;
-        (*packet) >> _long;
+        int32 _long = PacketReader(L, packet).Read<int32>();
         ALE::Push(L, _long);
         return 1;
     }
@@ -128,8 +193,7 @@ namespace LuaPacket
      */
     int ReadULong(lua_State* L, WorldPacket* packet)
     {
-        uint32 _ulong;
-        (*packet) >> _ulong;
+        uint32 _ulong = PacketReader(L, packet).Read<uint32>();
         ALE::Push(L, _ulong);
         return 1;
     }
@@ -141,8 +205,7 @@ namespace LuaPacket
      */
     int ReadFloat(lua_State* L, WorldPacket* packet)
     {
-        float _val;
-        (*packet) >> _val;
+        float _val = PacketReader(L, packet).Read<float>();
         ALE::Push(L, _val);
         return 1;
     }
@@ -154,8 +217,7 @@ namespace LuaPacket
      */
     int ReadDouble(lua_State* L, WorldPacket* packet)
     {
-        double _val;
-        (*packet) >> _val;
+        double _val = PacketReader(L, packet).Read<double>();
         ALE::Push(L, _val);
         return 1;
     }
@@ -167,8 +229,7 @@ namespace LuaPacket
      */
     int ReadGUID(lua_State* L, WorldPacket* packet)
     {
-        ObjectGuid guid;
-        (*packet) >> guid;
+        ObjectGuid guid(PacketReader(L, packet).Read<uint64>());
         ALE::Push(L, guid);
         return 1;
     }
@@ -181,8 +242,7 @@ namespace LuaPacket
      */
     int ReadPackedGUID(lua_State* L, WorldPacket* packet)
     {
-        uint64 guid;
-        packet->readPackGUID(guid);
+        uint64 guid = PacketReader(L, packet).ReadPackedGUID();
         ALE::Push(L, guid);
         return 1;
     }
@@ -194,8 +254,7 @@ namespace LuaPacket
      */
     int ReadString(lua_State* L, WorldPacket* packet)
     {
-        std::string _val;
-        (*packet) >> _val;
+        std::string _val = PacketReader(L, packet).ReadString();
         ALE::Push(L, _val);
         return 1;
     }
@@ -332,6 +391,18 @@ namespace LuaPacket
         (*packet) << _val;
         return 0;
     }
+
+    // Methods that don't change the packet, they work on views without copying them
+    inline bool IsReadOnly(int(*method)(lua_State*, WorldPacket*))
+    {
+        static int(* const readOnlyMethods[])(lua_State*, WorldPacket*) =
+        {
+            &GetOpcode, &GetSize,
+            &ReadByte, &ReadUByte, &ReadShort, &ReadUShort, &ReadLong, &ReadULong,
+            &ReadFloat, &ReadDouble, &ReadGUID, &ReadPackedGUID, &ReadString
+        };
+        return std::find(std::begin(readOnlyMethods), std::end(readOnlyMethods), method) != std::end(readOnlyMethods);
+    }
 };
 
 #endif
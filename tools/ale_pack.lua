@@ -0,0 +1,72 @@
+--[[
+    Packs a script folder into a single ALE script archive (see ALE.ScriptArchive).
+
+    Usage:
+        lua ale_pack.lua [-c] <script folder> <archive file>
+
+    -c  Store .lua and .ext files as bytecode. The interpreter running this tool must be
+        the same Lua version ALE was built with, otherwise the server can't load them.
+
+    Hidden files and folders are skipped like ALE does. MoonScript and native modules
+    can't be loaded from an archive, they are skipped too.
+]]
+
+local compile = false
+local args = {...}
+if args[1] == "-c" then
+    compile = true
+    table.remove(args, 1)
+end
+
+local root, output = args[1], args[2]
+if not root or not output then
+    io.stderr:write("usage: lua ale_pack.lua [-c] <script folder> <archive file>\n")
+    os.exit(1)
+end
+root = root:gsub("[/\\]+$", "")
+
+local listing
+if package.config:sub(1, 1) == "\\" then
+    listing = io.popen('dir /s /b /a-d "' .. root .. '"')
+else
+    listing = io.popen("find '" .. root .. "' -type f")
+end
+
+local files = {}
+for line in listing:lines() do
+    local path = line:gsub("\\", "/"):sub(#root + 2)
+    local hidden = ("/" .. path):find("/%.")
+    local ext = path:match("%.[^./]+$")
+    if not hidden and (ext == ".lua" or ext == ".ext" or ext == ".out") then
+        table.insert(files, path)
+    end
+end
+listing:close()
+table.sort(files)
+
+local index, contents = {}, {}
+for _, path in ipairs(files) do
+    local data
+    local ext = path:match("%.[^./]+$")
+    if compile and ext ~= ".out" then
+        local chunk, err = loadfile(root .. "/" .. path)
+        if not chunk then
+            io.stderr:write(err .. "\n")
+            os.exit(1)
+        end
+        data = string.dump(chunk)
+    else
+        local file = assert(io.open(root .. "/" .. path, "rb"))
+        data = file:read("*a")
+        file:close()
+    end
+
+    table.insert(index, path .. "\t" .. #data .. "\n")
+    table.insert(contents, data)
+end
+
+local archive = assert(io.open(output, "wb"))
+archive:write("ALEPACK 1\n", table.concat(index), "\n", table.concat(contents))
+archive:close()
+
+print(("Packed %d scripts into %s"):format(#files, output))
@@ -0,0 +1,24 @@
+// Stand-in for the module header, only what ALEEventMgr needs, see ../CMakeLists.txt
+#ifndef ALE_BENCH_ALE_UTILITY_H
+#define ALE_BENCH_ALE_UTILITY_H
+
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace ALEUtil
+{
+    class Lockable
+    {
+    public:
+        typedef std::recursive_mutex LockType;
+        typedef std::lock_guard<LockType> Guard;
+
+        LockType& GetLock() { return _lock; }
+
+    private:
+        LockType _lock;
+    };
+}
+
+#endif
@@ -0,0 +1,15 @@
+// Stand-in for the server header, see ../CMakeLists.txt
+#ifndef ALE_BENCH_COMMON_H
+#define ALE_BENCH_COMMON_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+typedef int32_t int32;
+typedef uint32_t uint32;
+typedef uint64_t uint64;
+
+#define ASSERT assert
+
+#endif
@@ -0,0 +1 @@
+// Stand-in for the server header, see ../CMakeLists.txt
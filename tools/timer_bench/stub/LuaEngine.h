@@ -0,0 +1,31 @@
+// Stand-in for the module header, only what ALEEventMgr needs, see ../CMakeLists.txt
+#ifndef ALE_BENCH_LUA_ENGINE_H
+#define ALE_BENCH_LUA_ENGINE_H
+
+#include "ALEEventMgr.h"
+#include "lua.h"
+
+class ALE
+{
+public:
+    typedef std::recursive_mutex LockType;
+    typedef std::lock_guard<LockType> Guard;
+
+    ALE() : L(nullptr), eventMgr(nullptr), timedEventCalls(0) { }
+
+    static bool IsInitialized() { return true; }
+    bool HasLuaState() const { return true; }
+    LockType& GetStateLock() { return stateLock; }
+
+    // Counts the calls instead of running a Lua function
+    void OnTimedEvent(int /*funcRef*/, uint32 /*delay*/, uint32 /*calls*/, WorldObject* /*obj*/) { ++timedEventCalls; }
+
+    lua_State* L;
+    EventMgr* eventMgr;
+    uint64 timedEventCalls;
+
+private:
+    LockType stateLock;
+};
+
+#endif
@@ -0,0 +1,7 @@
+// Stand-in for the server header, see ../CMakeLists.txt
+#ifndef ALE_BENCH_OBJECT_H
+#define ALE_BENCH_OBJECT_H
+
+class WorldObject { };
+
+#endif
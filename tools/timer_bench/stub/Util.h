@@ -0,0 +1,14 @@
+// Stand-in for the server header, see ../CMakeLists.txt
+#ifndef ALE_BENCH_UTIL_H
+#define ALE_BENCH_UTIL_H
+
+#include "Common.h"
+#include <random>
+
+inline uint32 urand(uint32 min, uint32 max)
+{
+    static std::mt19937 generator(1);
+    return std::uniform_int_distribution<uint32>(min, max)(generator);
+}
+
+#endif
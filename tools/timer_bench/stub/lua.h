@@ -0,0 +1,9 @@
+// Stand-in for the Lua header, see ../CMakeLists.txt
+#ifndef ALE_BENCH_LUA_H
+#define ALE_BENCH_LUA_H
+
+typedef struct lua_State lua_State;
+
+#define LUA_REGISTRYINDEX (-10000)
+
+#endif
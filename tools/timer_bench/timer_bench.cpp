@@ -0,0 +1,165 @@
+/*
+* Copyright (C) 2010 - 2025 Eluna Lua Engine <https://elunaluaengine.github.io/>
+* This program is free software licensed under GPL version 3
+* Please see the included DOCS/LICENSE.md for more information
+*/
+
+/*
+ * Compares the timer wheel of ALEEventProcessor with the multimap it replaced.
+ *
+ * Each run adds N repeating timed events with delays spread over 100 ms to 60 s to one processor,
+ *   runs 60 seconds of 50 ms server ticks and removes the events again. The timed event calls are
+ *   only counted, so the times are those of the processor itself.
+ *
+ * Usage: ale_timer_bench [N...]   (default: 10000 100000 1000000)
+ */
+
+#include "ALEEventMgr.h"
+#include "LuaEngine.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+namespace
+{
+    // The event processor before the timer wheel, events ordered by expire time in a multimap
+    class MultimapEventProcessor
+    {
+    public:
+        MultimapEventProcessor(ALE** _E, WorldObject* /*obj*/) : m_time(0), E(_E) { }
+
+        ~MultimapEventProcessor()
+        {
+            for (auto& event : eventList)
+                RemoveEvent(event.second);
+        }
+
+        void Update(uint32 diff)
+        {
+            m_time += diff;
+            for (auto it = eventList.begin(); it != eventList.end() && it->first <= m_time; it = eventList.begin())
+            {
+                LuaEvent* luaEvent = it->second;
+                eventList.erase(it);
+
+                if (luaEvent->state != LUAEVENT_STATE_ERASE)
+                    eventMap.erase(luaEvent->funcRef);
+
+                if (luaEvent->state == LUAEVENT_STATE_RUN)
+                {
+                    uint32 delay = luaEvent->delay;
+                    bool remove = luaEvent->repeats == 1;
+                    if (!remove)
+                        AddEvent(luaEvent);
+
+                    (*E)->OnTimedEvent(luaEvent->funcRef, delay, luaEvent->repeats ? luaEvent->repeats-- : luaEvent->repeats, NULL);
+
+                    if (!remove)
+                        continue;
+                }
+
+                RemoveEvent(luaEvent);
+            }
+        }
+
+        void AddEvent(int funcRef, uint32 min, uint32 max, uint32 repeats)
+        {
+            AddEvent(new LuaEvent(funcRef, min, max, repeats));
+            (*E)->eventMgr->AddEventOwner(funcRef, nullptr);
+        }
+
+    private:
+        void AddEvent(LuaEvent* luaEvent)
+        {
+            luaEvent->GenerateDelay();
+            eventList.insert(std::pair<uint64, LuaEvent*>(m_time + luaEvent->delay, luaEvent));
+            eventMap[luaEvent->funcRef] = luaEvent;
+        }
+
+        void RemoveEvent(LuaEvent* luaEvent)
+        {
+            if (luaEvent->state != LUAEVENT_STATE_ERASE)
+                (*E)->eventMgr->RemoveEventOwner(luaEvent->funcRef, nullptr);
+            delete luaEvent;
+        }
+
+        std::multimap<uint64, LuaEvent*> eventList;
+        std::unordered_map<int, LuaEvent*> eventMap;
+        uint64 m_time;
+        ALE** E;
+    };
+
+    static constexpr uint32 TICK = 50;
+    static constexpr uint32 RUN_TIME = 60 * 1000;
+
+    struct Result
+    {
+        double addMs;
+        double runMs;
+        double removeMs;
+        uint64 calls;
+    };
+
+    double MsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    template<typename P>
+    Result Run(uint32 count)
+    {
+        ALE state;
+        ALE* E = &state;
+        EventMgr eventMgr(&E);
+        state.eventMgr = &eventMgr;
+
+        Result result;
+        auto start = std::chrono::steady_clock::now();
+        P* processor = new P(&E, nullptr);
+        for (uint32 i = 0; i < count; ++i)
+        {
+            // Fixed delays so both processors call the same events
+            uint32 delay = 100 + (uint64(i) * 7919) % (RUN_TIME - 100);
+            processor->AddEvent(int(i + 1), delay, delay, 0);
+        }
+        result.addMs = MsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        for (uint32 time = 0; time < RUN_TIME; time += TICK)
+            processor->Update(TICK);
+        result.runMs = MsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        delete processor;
+        result.removeMs = MsSince(start);
+
+        result.calls = state.timedEventCalls;
+        return result;
+    }
+
+    void Print(const char* name, uint32 count, const Result& result)
+    {
+        printf("%-9s %8u %10.2f %10.2f %10.3f %10.2f %10llu\n", name, count, result.addMs, result.runMs,
+            result.runMs / (RUN_TIME / TICK), result.removeMs, (unsigned long long)result.calls);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<uint32> counts;
+    for (int i = 1; i < argc; ++i)
+        counts.push_back(uint32(strtoul(argv[i], nullptr, 10)));
+    if (counts.empty())
+        counts = { 10000, 100000, 1000000 };
+
+    printf("%-9s %8s %10s %10s %10s %10s %10s\n", "", "timers", "add ms", "run ms", "ms/tick", "remove ms", "calls");
+    for (uint32 count : counts)
+    {
+        Print("wheel", count, Run<ALEEventProcessor>(count));
+        Print("multimap", count, Run<MultimapEventProcessor>(count));
+    }
+    return 0;
+}